@@ -0,0 +1,47 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Instanced variant of object.vert for the augmented image frames.  Each
+// instance is one image, and u_CornerOffset places the corner model being
+// drawn at a corner of it.
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+uniform vec2 u_CornerOffset;
+attribute vec4 a_Position;
+attribute vec3 a_Normal;
+attribute vec2 a_TexCoord;
+attribute mat4 a_Center;
+attribute vec2 a_HalfExtent;
+attribute vec4 a_ColorTint;
+varying vec3 v_ViewPosition;
+varying vec3 v_ViewNormal;
+varying vec3 v_ViewLightDirection;
+varying vec2 v_TexCoord;
+varying vec4 v_ColorTint;
+
+void main() {
+  vec2 corner = u_CornerOffset * a_HalfExtent;
+  vec4 position = a_Position + vec4(corner.x, 0.0, corner.y, 0.0);
+  mat4 modelView = u_View * a_Center;
+  vec4 viewPosition = modelView * position;
+  v_ViewPosition = viewPosition.xyz;
+  v_ViewNormal = normalize((modelView * vec4(a_Normal, 0.0)).xyz);
+  // The light points along the image's normal.
+  v_ViewLightDirection = normalize((modelView * vec4(0.0, 1.0, 0.0, 0.0)).xyz);
+  v_TexCoord = a_TexCoord;
+  v_ColorTint = a_ColorTint;
+  gl_Position = u_Projection * viewPosition;
+}
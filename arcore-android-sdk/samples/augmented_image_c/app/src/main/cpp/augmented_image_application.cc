@@ -21,7 +21,6 @@
 #include <cstdint>
 #include <utility>
 
-#include "obj_renderer.h"
 #include "util.h"
 
 namespace augmented_image {
@@ -336,7 +335,7 @@ bool AugmentedImageApplication::DrawAugmentedImage(
     ArTrackable_getTrackingState(ar_session_, ArAsTrackable(ar_image),
                                  &tracking_state);
 
-    // Draw this image frame.
+    // Queue this image frame, they are all drawn together below.
     if (tracking_state == AR_TRACKING_STATE_TRACKING) {
       // Use Index to get tint color.
       int index;
@@ -349,10 +348,11 @@ bool AugmentedImageApplication::DrawAugmentedImage(
           ((tint_color_hex & 0x0000FF00) >> 8) / 255.0f * kTintIntensity,
           kTintAlpha};
 
-      image_renderer_.Draw(projection_mat, view_mat, color_correction,
-                           tint_color_rgba, ar_session_, ar_image, ar_anchor);
+      image_renderer_.AddImage(ar_session_, ar_image, ar_anchor,
+                               tint_color_rgba);
     }
   }
+  image_renderer_.Draw(projection_mat, view_mat, color_correction);
 
   return found_ar_image;
 }
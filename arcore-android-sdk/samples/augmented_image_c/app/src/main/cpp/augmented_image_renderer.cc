@@ -15,57 +15,210 @@
  */
 
 #include "augmented_image_renderer.h"
+#include <cstddef>
+#include "mesh.h"
 #include "util.h"
 
 namespace augmented_image {
+namespace {
+constexpr char kVertexShaderFilename[] = "shaders/image_frame.vert";
+constexpr char kFragmentShaderFilename[] = "shaders/image_frame.frag";
+constexpr char kTextureFilename[] = "models/frame_base.png";
+
+// Frame material.
+constexpr float kAmbient = 0.0f;
+constexpr float kDiffuse = 2.0f;
+constexpr float kSpecular = 0.5f;
+constexpr float kSpecularPower = 6.0f;
+}  // namespace
 
 void AugmentedImageRenderer::InitializeGlContent(AAssetManager* asset_manager) {
-  image_frame_upper_left.InitializeGlContent(
-      asset_manager, "models/frame_upper_left.obj", "models/frame_base.png");
-  image_frame_upper_right.InitializeGlContent(
-      asset_manager, "models/frame_upper_right.obj", "models/frame_base.png");
-  image_frame_lower_left.InitializeGlContent(
-      asset_manager, "models/frame_lower_left.obj", "models/frame_base.png");
-  image_frame_lower_right.InitializeGlContent(
-      asset_manager, "models/frame_lower_right.obj", "models/frame_base.png");
+  shader_program_ = util::CreateProgram(asset_manager, kVertexShaderFilename,
+                                        kFragmentShaderFilename);
+  if (!shader_program_) {
+    LOGE("Could not create program.");
+  }
+
+  uniform_view_mat_ = glGetUniformLocation(shader_program_, "u_View");
+  uniform_projection_mat_ =
+      glGetUniformLocation(shader_program_, "u_Projection");
+  uniform_corner_offset_ =
+      glGetUniformLocation(shader_program_, "u_CornerOffset");
+  uniform_texture_ = glGetUniformLocation(shader_program_, "u_Texture");
+  uniform_material_param_ =
+      glGetUniformLocation(shader_program_, "u_MaterialParameters");
+  uniform_color_correction_param_ =
+      glGetUniformLocation(shader_program_, "u_ColorCorrectionParameters");
+
+  attri_vertices_ = glGetAttribLocation(shader_program_, "a_Position");
+  attri_uvs_ = glGetAttribLocation(shader_program_, "a_TexCoord");
+  attri_normals_ = glGetAttribLocation(shader_program_, "a_Normal");
+  attri_center_ = glGetAttribLocation(shader_program_, "a_Center");
+  attri_half_extent_ = glGetAttribLocation(shader_program_, "a_HalfExtent");
+  attri_color_tint_ = glGetAttribLocation(shader_program_, "a_ColorTint");
+
+  // The four corners share one texture.
+  glGenTextures(1, &texture_id_);
+  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  if (!util::LoadPngFromAssetManager(GL_TEXTURE_2D, kTextureFilename)) {
+    LOGE("Could not load png texture for image frames.");
+  }
+  glGenerateMipmap(GL_TEXTURE_2D);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenBuffers(1, &instance_buffer_);
+
+  InitializeCorner(asset_manager, "models/frame_upper_left.obj",
+                   glm::vec2(-1.0f, -1.0f), &corners_[0]);
+  InitializeCorner(asset_manager, "models/frame_upper_right.obj",
+                   glm::vec2(1.0f, -1.0f), &corners_[1]);
+  InitializeCorner(asset_manager, "models/frame_lower_left.obj",
+                   glm::vec2(-1.0f, 1.0f), &corners_[2]);
+  InitializeCorner(asset_manager, "models/frame_lower_right.obj",
+                   glm::vec2(1.0f, 1.0f), &corners_[3]);
+
+  util::CheckGlError("augmented_image_renderer::InitializeGlContent()");
 }
 
-void AugmentedImageRenderer::Draw(const glm::mat4& projection_mat,
-                                  const glm::mat4& view_mat,
-                                  const float* color_correction4,
-                                  const float* color_tint_rgba,
-                                  const ArSession* ar_session,
-                                  const ArAugmentedImage* ar_image,
-                                  const ArAnchor* ar_anchor) const {
+void AugmentedImageRenderer::InitializeCorner(AAssetManager* asset_manager,
+                                              const char* obj_file_name,
+                                              const glm::vec2& offset,
+                                              Corner* corner) {
+  corner->offset = offset;
+
+  Mesh mesh;
+  if (!mesh.Load(asset_manager, obj_file_name)) {
+    return;
+  }
+  corner->index_count = mesh.GetIndexCount();
+  corner->index_type = mesh.GetIndexType();
+  const GLsizei index_size = corner->index_type == GL_UNSIGNED_SHORT
+                                 ? sizeof(GLushort)
+                                 : sizeof(GLuint);
+
+  glGenVertexArrays(1, &corner->vertex_array);
+  glBindVertexArray(corner->vertex_array);
+
+  glGenBuffers(1, &corner->index_buffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, corner->index_buffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, corner->index_count * index_size,
+               mesh.GetIndices(), GL_STATIC_DRAW);
+
+  glGenBuffers(1, &corner->vertex_buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, corner->vertex_buffer);
+  glBufferData(GL_ARRAY_BUFFER, mesh.GetVertexCount() * sizeof(Mesh::Vertex),
+               mesh.GetVertices(), GL_STATIC_DRAW);
+
+  const GLsizei stride = sizeof(Mesh::Vertex);
+  glEnableVertexAttribArray(attri_vertices_);
+  glVertexAttribPointer(attri_vertices_, 3, GL_FLOAT, GL_FALSE, stride,
+      reinterpret_cast<const void*>(offsetof(Mesh::Vertex, position)));
+  glEnableVertexAttribArray(attri_normals_);
+  glVertexAttribPointer(attri_normals_, 3, GL_FLOAT, GL_FALSE, stride,
+      reinterpret_cast<const void*>(offsetof(Mesh::Vertex, normal)));
+  glEnableVertexAttribArray(attri_uvs_);
+  glVertexAttribPointer(attri_uvs_, 2, GL_FLOAT, GL_FALSE, stride,
+      reinterpret_cast<const void*>(offsetof(Mesh::Vertex, uv)));
+
+  // Instance attributes advance once per image.  The mat4 takes four
+  // attribute locations, one per column.
+  glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+  const GLsizei instance_stride = sizeof(Instance);
+  for (int column = 0; column < 4; ++column) {
+    glEnableVertexAttribArray(attri_center_ + column);
+    glVertexAttribPointer(attri_center_ + column, 4, GL_FLOAT, GL_FALSE,
+        instance_stride,
+        reinterpret_cast<const void*>(offsetof(Instance, center) +
+                                      column * sizeof(glm::vec4)));
+    glVertexAttribDivisor(attri_center_ + column, 1);
+  }
+  glEnableVertexAttribArray(attri_half_extent_);
+  glVertexAttribPointer(attri_half_extent_, 2, GL_FLOAT, GL_FALSE,
+      instance_stride,
+      reinterpret_cast<const void*>(offsetof(Instance, half_extent)));
+  glVertexAttribDivisor(attri_half_extent_, 1);
+  glEnableVertexAttribArray(attri_color_tint_);
+  glVertexAttribPointer(attri_color_tint_, 4, GL_FLOAT, GL_FALSE,
+      instance_stride,
+      reinterpret_cast<const void*>(offsetof(Instance, color_tint)));
+  glVertexAttribDivisor(attri_color_tint_, 1);
+
+  // The other renderers draw from client memory.
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void AugmentedImageRenderer::AddImage(const ArSession* ar_session,
+                                      const ArAugmentedImage* ar_image,
+                                      const ArAnchor* ar_anchor,
+                                      const float* color_tint_rgba) {
   // Get image extents.
   float extent_x, extent_z;
   ArAugmentedImage_getExtentX(ar_session, ar_image, &extent_x);
   ArAugmentedImage_getExtentZ(ar_session, ar_image, &extent_z);
 
-  glm::mat4 local_upper_left_matrix = glm::translate(
-      glm::mat4(1.0), glm::vec3(-0.5f * extent_x, 0.0f, -0.5f * extent_z));
-  glm::mat4 local_upper_right_matrix = glm::translate(
-      glm::mat4(1.0), glm::vec3(0.5f * extent_x, 0.0f, -0.5f * extent_z));
-  glm::mat4 local_lower_right_matrix = glm::translate(
-      glm::mat4(1.0), glm::vec3(0.5f * extent_x, 0.0f, 0.5f * extent_z));
-  glm::mat4 local_lower_left_matrix = glm::translate(
-      glm::mat4(1.0), glm::vec3(-0.5f * extent_x, 0.0f, 0.5f * extent_z));
-
-  glm::mat4 center_matrix;
-  util::GetTransformMatrixFromAnchor(ar_session, ar_anchor, &center_matrix);
-
-  image_frame_upper_left.Draw(projection_mat, view_mat,
-                              center_matrix * local_upper_left_matrix,
-                              color_correction4, color_tint_rgba);
-  image_frame_upper_right.Draw(projection_mat, view_mat,
-                               center_matrix * local_upper_right_matrix,
-                               color_correction4, color_tint_rgba);
-  image_frame_lower_left.Draw(projection_mat, view_mat,
-                              center_matrix * local_lower_left_matrix,
-                              color_correction4, color_tint_rgba);
-  image_frame_lower_right.Draw(projection_mat, view_mat,
-                               center_matrix * local_lower_right_matrix,
-                               color_correction4, color_tint_rgba);
+  Instance instance;
+  util::GetTransformMatrixFromAnchor(ar_session, ar_anchor, &instance.center);
+  instance.half_extent = glm::vec2(0.5f * extent_x, 0.5f * extent_z);
+  instance.color_tint =
+      glm::vec4(color_tint_rgba[0], color_tint_rgba[1], color_tint_rgba[2],
+                color_tint_rgba[3]);
+  instances_.push_back(instance);
+}
+
+void AugmentedImageRenderer::Draw(const glm::mat4& projection_mat,
+                                  const glm::mat4& view_mat,
+                                  const float* color_correction4) {
+  if (instances_.empty()) {
+    return;
+  }
+  if (!shader_program_) {
+    LOGE("shader_program is null.");
+    instances_.clear();
+    return;
+  }
+
+  glUseProgram(shader_program_);
+
+  glActiveTexture(GL_TEXTURE0);
+  glUniform1i(uniform_texture_, 0);
+  glBindTexture(GL_TEXTURE_2D, texture_id_);
+
+  glUniformMatrix4fv(uniform_view_mat_, 1, GL_FALSE,
+                     glm::value_ptr(view_mat));
+  glUniformMatrix4fv(uniform_projection_mat_, 1, GL_FALSE,
+                     glm::value_ptr(projection_mat));
+  glUniform4f(uniform_material_param_, kAmbient, kDiffuse, kSpecular,
+              kSpecularPower);
+  glUniform4fv(uniform_color_correction_param_, 1, color_correction4);
+
+  glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, instances_.size() * sizeof(Instance),
+               instances_.data(), GL_STREAM_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  for (const Corner& corner : corners_) {
+    if (corner.index_count == 0) {
+      continue;
+    }
+    glUniform2f(uniform_corner_offset_, corner.offset.x, corner.offset.y);
+    glBindVertexArray(corner.vertex_array);
+    glDrawElementsInstanced(GL_TRIANGLES, corner.index_count,
+                            corner.index_type, nullptr, instances_.size());
+  }
+  glBindVertexArray(0);
+
+  glUseProgram(0);
+  util::CheckGlError("augmented_image_renderer::Draw()");
+
+  instances_.clear();
 }
 
 }  // namespace augmented_image
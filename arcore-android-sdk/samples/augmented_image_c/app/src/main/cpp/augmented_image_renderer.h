@@ -17,15 +17,21 @@
 #ifndef C_ARCORE_AUGMENTED_IMAGE_AUGMENTED_IMAGE_RENDERER_H_
 #define C_ARCORE_AUGMENTED_IMAGE_AUGMENTED_IMAGE_RENDERER_H_
 
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
 #include <android/asset_manager.h>
+#include <vector>
 
 #include "arcore_c_api.h"
 #include "glm.h"
-#include "obj_renderer.h"
 
 namespace augmented_image {
 
 // AugmentedImageRenderer handles the display of image frame on ArAugmentedImage
+//
+// The frames of all images added for a frame are drawn together, with one
+// instanced draw per frame corner model.
 class AugmentedImageRenderer {
  public:
   AugmentedImageRenderer() = default;
@@ -35,17 +41,60 @@ class AugmentedImageRenderer {
   // other methods below.
   void InitializeGlContent(AAssetManager* asset_manager);
 
-  // Draws frames on ArAugmentedImage, with center location at ArAnchor.
+  // Adds a frame on ArAugmentedImage, with center location at ArAnchor, to be
+  // drawn by the next Draw().
+  void AddImage(const ArSession* ar_session, const ArAugmentedImage* ar_image,
+                const ArAnchor* ar_anchor, const float* color_tint_rgba);
+
+  // Draws the frames of all images added since the last call.
   void Draw(const glm::mat4& projection_mat, const glm::mat4& view_mat,
-            const float* color_correction4, const float* color_tint_rgba,
-            const ArSession* ar_session, const ArAugmentedImage* ar_image,
-            const ArAnchor* ar_anchor) const;
+            const float* color_correction4);
 
  private:
-  ObjRenderer image_frame_upper_left;
-  ObjRenderer image_frame_upper_right;
-  ObjRenderer image_frame_lower_left;
-  ObjRenderer image_frame_lower_right;
+  // One of the four frame corner models, placed at a corner of each image.
+  struct Corner {
+    GLuint vertex_buffer = 0;
+    GLuint index_buffer = 0;
+    GLuint vertex_array = 0;
+    GLsizei index_count = 0;
+    GLenum index_type = GL_UNSIGNED_SHORT;
+    // Corner position, in half image extents.
+    glm::vec2 offset;
+  };
+
+  // Per-image instance attributes.
+  struct Instance {
+    glm::mat4 center;
+    glm::vec2 half_extent;
+    glm::vec4 color_tint;
+  };
+
+  // Loads a corner model and binds its vertex and instance attributes.
+  void InitializeCorner(AAssetManager* asset_manager,
+                        const char* obj_file_name, const glm::vec2& offset,
+                        Corner* corner);
+
+  Corner corners_[4];
+  std::vector<Instance> instances_;
+  GLuint instance_buffer_ = 0;
+
+  // Loaded TEXTURE_2D object name
+  GLuint texture_id_ = 0;
+
+  // Shader program details
+  GLuint shader_program_ = 0;
+  GLint attri_vertices_;
+  GLint attri_uvs_;
+  GLint attri_normals_;
+  GLint attri_center_;
+  GLint attri_half_extent_;
+  GLint attri_color_tint_;
+  GLint uniform_view_mat_;
+  GLint uniform_projection_mat_;
+  GLint uniform_corner_offset_;
+  GLint uniform_texture_;
+  GLint uniform_material_param_;
+  GLint uniform_color_correction_param_;
 };
 
 }  // namespace augmented_image
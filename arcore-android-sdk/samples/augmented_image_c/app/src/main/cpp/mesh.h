@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_AUGMENTED_IMAGE_MESH_
+#define C_ARCORE_AUGMENTED_IMAGE_MESH_
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <android/asset_manager.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace augmented_image {
+
+// Header of a binary .mesh file, written by tools/obj_to_mesh.  It is followed
+// by vertex_count Mesh::Vertex structs, then index_count indices of index_size
+// bytes.  All values are little-endian.
+struct MeshFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t vertex_count;
+  uint32_t index_count;
+  uint32_t index_size;
+};
+
+// Indexed triangle mesh with interleaved vertices.  The .mesh file next to an
+// OBJ is used straight from the APK when it is packaged, otherwise the OBJ is
+// parsed.
+class Mesh {
+ public:
+  struct Vertex {
+    GLfloat position[3];
+    GLfloat normal[3];
+    GLfloat uv[2];
+  };
+
+  Mesh() = default;
+  ~Mesh();
+
+  // Loads the mesh for obj_file_name, replacing any previous one.
+  // @return true if either the binary mesh or the OBJ is loaded.
+  bool Load(AAssetManager* asset_manager, const std::string& obj_file_name);
+
+  const Vertex* GetVertices() const { return vertices_; }
+  GLsizei GetVertexCount() const { return vertex_count_; }
+  const void* GetIndices() const { return indices_; }
+  GLsizei GetIndexCount() const { return index_count_; }
+  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+  GLenum GetIndexType() const { return index_type_; }
+
+  // Delete copy constructors.
+  Mesh(const Mesh&) = delete;
+  void operator=(const Mesh&) = delete;
+
+ private:
+  // Maps the binary mesh, returning false if it is missing or invalid.
+  bool LoadBinary(AAssetManager* asset_manager, const std::string& file_name);
+  bool LoadObj(AAssetManager* asset_manager, const std::string& file_name);
+  void Release();
+
+  // Open while vertices_ and indices_ point into its buffer.
+  AAsset* asset_ = nullptr;
+  const Vertex* vertices_ = nullptr;
+  GLsizei vertex_count_ = 0;
+  const void* indices_ = nullptr;
+  GLsizei index_count_ = 0;
+  GLenum index_type_ = GL_UNSIGNED_SHORT;
+
+  // Storage for a mesh parsed from OBJ, with 16-bit indices when they fit.
+  std::vector<Vertex> obj_vertices_;
+  std::vector<GLushort> obj_indices16_;
+  std::vector<GLuint> obj_indices32_;
+};
+}  // namespace augmented_image
+
+#endif  // C_ARCORE_AUGMENTED_IMAGE_MESH_
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2018 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef C_ARCORE_AUGMENTED_IMAGE_OBJ_PARSER_H_
+#define C_ARCORE_AUGMENTED_IMAGE_OBJ_PARSER_H_
+
+#include <GLES2/gl2.h>
+#include <vector>
+
+namespace augmented_image {
+namespace util {
+
+// Parses Wavefront OBJ text, as read by LoadObjFile().
+//
+// @param begin, end: the OBJ text, which need not be null terminated.
+// @param out_vertices, output vertices.
+// @param out_normals, output normals.
+// @param out_uv, output texture UV coordinates.
+// @param out_indices, output triangle indices.
+// @param out_error_line, set to the offending line on failure, may be null.
+// @return true if the OBJ is parsed, otherwise false with empty outputs.
+bool ParseObj(const char* begin, const char* end,
+              std::vector<GLfloat>* out_vertices,
+              std::vector<GLfloat>* out_normals,
+              std::vector<GLfloat>* out_uv,
+              std::vector<GLuint>* out_indices, int* out_error_line);
+
+}  // namespace util
+}  // namespace augmented_image
+
+#endif  // C_ARCORE_AUGMENTED_IMAGE_OBJ_PARSER_H_
@@ -140,11 +140,15 @@ bool HideFitToScanImage(void* activity);
 // @param out_uv, output texture UV coordinates.
 // @param out_indices, output triangle indices.
 // @return true if obj is loaded correctly, otherwise false.
+//
+// Outputs are replaced, with vertices shared by faces output once.  Normals
+// and UVs are left empty if the OBJ has none, and zero for vertices without
+// them otherwise.
 bool LoadObjFile(AAssetManager* mgr, const std::string& file_name,
                  std::vector<GLfloat>* out_vertices,
                  std::vector<GLfloat>* out_normals,
                  std::vector<GLfloat>* out_uv,
-                 std::vector<GLushort>* out_indices);
+                 std::vector<GLuint>* out_indices);
 
 // Formats and outputs the matrix to logcat file.
 // Note that this function output matrix in row major.
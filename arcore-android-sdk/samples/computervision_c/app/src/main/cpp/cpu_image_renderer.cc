@@ -29,7 +29,6 @@ const GLfloat kVertices[] = {
     -1.0f, -1.0f, +1.0f, -1.0f, -1.0f, +1.0f, +1.0f, +1.0f,
 };
 
-constexpr int kSobelEdgeThreshold = 128 * 128;
 constexpr int kCoordsPerVertex = 2;
 constexpr int kTexCoordsPerVertex = 2;
 constexpr char kVertexShaderFilename[] = "shaders/cpu_image.vert";
@@ -70,7 +69,8 @@ bool GetNdkImageProperties(const AImage* ndk_image, int32_t* out_format,
 }
 
 bool DetectEdge(const AImage* ndk_image, int32_t width, int32_t height,
-                int32_t stride, uint8_t* output_pixels) {
+                int32_t stride, EdgeDetector* edge_detector,
+                uint8_t* output_pixels) {
   if (ndk_image == nullptr || output_pixels == nullptr) {
     return false;
   }
@@ -84,40 +84,7 @@ bool DetectEdge(const AImage* ndk_image, int32_t width, int32_t height,
   }
 
   // Detect edges.
-  for (int j = 1; j < height - 1; j++) {
-    for (int i = 1; i < width - 1; i++) {
-      // Offset of the pixel at [i, j] of the input image.
-      int offset = (j * stride) + i;
-
-      // Neighbour pixels around the pixel at [i, j].
-      int a00 = input_pixels[offset - stride - 1];
-      int a01 = input_pixels[offset - stride];
-      int a02 = input_pixels[offset - stride + 1];
-      int a10 = input_pixels[offset - 1];
-      int a12 = input_pixels[offset + 1];
-      int a20 = input_pixels[offset + stride - 1];
-      int a21 = input_pixels[offset + stride];
-      int a22 = input_pixels[offset + stride + 1];
-
-      // Sobel X filter:
-      //   -1, 0, 1,
-      //   -2, 0, 2,
-      //   -1, 0, 1
-      int x_sum = -a00 - (2 * a10) - a20 + a02 + (2 * a12) + a22;
-
-      // Sobel Y filter:
-      //    1, 2, 1,
-      //    0, 0, 0,
-      //   -1, -2, -1
-      int y_sum = a00 + (2 * a01) + a02 - a20 - (2 * a21) - a22;
-
-      if ((x_sum * x_sum) + (y_sum * y_sum) > kSobelEdgeThreshold) {
-        output_pixels[(j * width) + i] = static_cast<uint8_t>(0xFF);
-      } else {
-        output_pixels[(j * width) + i] = static_cast<uint8_t>(0x1F);
-      }
-    }
-  }
+  edge_detector->Detect(input_pixels, width, height, stride, output_pixels);
   return true;
 }
 
@@ -177,7 +144,7 @@ void CpuImageRenderer::Draw(const ArSession* session, const ArFrame* frame,
             processed_image_bytes_grayscale_ =
                 std::unique_ptr<uint8_t[]>(new uint8_t[cpu_image_buffer_size_]);
           }
-          DetectEdge(ndk_image, width, height, stride,
+          DetectEdge(ndk_image, width, height, stride, &edge_detector_,
                      processed_image_bytes_grayscale_.get());
           is_valid_cpu_image = true;
         }
@@ -24,6 +24,7 @@
 #include <memory>
 
 #include "arcore_c_api.h"
+#include "edge_detector.h"
 #include "util.h"
 
 namespace computer_vision {
@@ -64,6 +65,7 @@ class CpuImageRenderer {
   float transformed_img_coord_[kNumVertices * 2];
   std::unique_ptr<uint8_t[]> processed_image_bytes_grayscale_;
   int cpu_image_buffer_size_ = 0;
+  EdgeDetector edge_detector_;
 };
 }  // namespace computer_vision
 #endif  // C_ARCORE_COMPUTER_VISION_BACKGROUND_RENDERER_H_
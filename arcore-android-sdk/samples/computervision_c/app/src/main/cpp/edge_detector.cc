@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "edge_detector.h"
+
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define EDGE_DETECTOR_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define EDGE_DETECTOR_SSE2 1
+#endif
+
+namespace computer_vision {
+namespace {
+constexpr int kSobelEdgeThreshold = 128 * 128;
+constexpr uint8_t kEdgePixel = 0xFF;
+constexpr uint8_t kNonEdgePixel = 0x1F;
+
+// Gradients are clamped to this before squaring in 16 bits.  Any larger
+// magnitude is an edge on its own, and 2 * 181^2 still fits in a uint16.
+constexpr int kMaxGradient = 181;
+
+// Rows per tile handed to a worker.
+constexpr int32_t kTileRows = 32;
+// Worker threads, besides the calling thread.
+constexpr unsigned kMaxWorkers = 3;
+
+uint8_t DetectEdgePixel(const uint8_t* pixel, int32_t stride) {
+  // Neighbour pixels around the pixel.
+  const int a00 = pixel[-stride - 1];
+  const int a01 = pixel[-stride];
+  const int a02 = pixel[-stride + 1];
+  const int a10 = pixel[-1];
+  const int a12 = pixel[1];
+  const int a20 = pixel[stride - 1];
+  const int a21 = pixel[stride];
+  const int a22 = pixel[stride + 1];
+
+  // Sobel X filter:
+  //   -1, 0, 1,
+  //   -2, 0, 2,
+  //   -1, 0, 1
+  const int x_sum = -a00 - (2 * a10) - a20 + a02 + (2 * a12) + a22;
+
+  // Sobel Y filter:
+  //    1, 2, 1,
+  //    0, 0, 0,
+  //   -1, -2, -1
+  const int y_sum = a00 + (2 * a01) + a02 - a20 - (2 * a21) - a22;
+
+  return (x_sum * x_sum) + (y_sum * y_sum) > kSobelEdgeThreshold
+             ? kEdgePixel
+             : kNonEdgePixel;
+}
+
+#if EDGE_DETECTOR_NEON
+constexpr int32_t kVectorPixels = 16;
+
+// Edge mask of 8 pixels, from the widened left, center and right pixels of
+// the rows above (0), at (1) and below (2).
+uint8x8_t DetectEdge8(int16x8_t l0, int16x8_t c0, int16x8_t r0, int16x8_t l1,
+                      int16x8_t r1, int16x8_t l2, int16x8_t c2,
+                      int16x8_t r2) {
+  const int16x8_t x_sum = vaddq_s16(
+      vaddq_s16(vsubq_s16(r0, l0), vsubq_s16(r2, l2)),
+      vshlq_n_s16(vsubq_s16(r1, l1), 1));
+  const int16x8_t y_sum = vsubq_s16(
+      vaddq_s16(vaddq_s16(l0, r0), vshlq_n_s16(c0, 1)),
+      vaddq_s16(vaddq_s16(l2, r2), vshlq_n_s16(c2, 1)));
+
+  const int16x8_t max_gradient = vdupq_n_s16(kMaxGradient);
+  const uint16x8_t x_abs =
+      vreinterpretq_u16_s16(vminq_s16(vabsq_s16(x_sum), max_gradient));
+  const uint16x8_t y_abs =
+      vreinterpretq_u16_s16(vminq_s16(vabsq_s16(y_sum), max_gradient));
+  const uint16x8_t magnitude =
+      vmlaq_u16(vmulq_u16(x_abs, x_abs), y_abs, y_abs);
+  return vmovn_u16(
+      vcgtq_u16(magnitude, vdupq_n_u16(kSobelEdgeThreshold)));
+}
+
+inline int16x8_t WidenLow(uint8x16_t pixels) {
+  return vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(pixels)));
+}
+
+inline int16x8_t WidenHigh(uint8x16_t pixels) {
+  return vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(pixels)));
+}
+
+// Writes 16 output pixels starting at pixel.
+void DetectEdge16(const uint8_t* pixel, int32_t stride, uint8_t* out) {
+  const uint8_t* above = pixel - stride;
+  const uint8_t* below = pixel + stride;
+  const uint8x16_t l0 = vld1q_u8(above - 1);
+  const uint8x16_t c0 = vld1q_u8(above);
+  const uint8x16_t r0 = vld1q_u8(above + 1);
+  const uint8x16_t l1 = vld1q_u8(pixel - 1);
+  const uint8x16_t r1 = vld1q_u8(pixel + 1);
+  const uint8x16_t l2 = vld1q_u8(below - 1);
+  const uint8x16_t c2 = vld1q_u8(below);
+  const uint8x16_t r2 = vld1q_u8(below + 1);
+
+  const uint8x16_t edges = vcombine_u8(
+      DetectEdge8(WidenLow(l0), WidenLow(c0), WidenLow(r0), WidenLow(l1),
+                  WidenLow(r1), WidenLow(l2), WidenLow(c2), WidenLow(r2)),
+      DetectEdge8(WidenHigh(l0), WidenHigh(c0), WidenHigh(r0), WidenHigh(l1),
+                  WidenHigh(r1), WidenHigh(l2), WidenHigh(c2), WidenHigh(r2)));
+  vst1q_u8(out, vbslq_u8(edges, vdupq_n_u8(kEdgePixel),
+                         vdupq_n_u8(kNonEdgePixel)));
+}
+#elif EDGE_DETECTOR_SSE2
+constexpr int32_t kVectorPixels = 16;
+
+// Non-edge mask of 8 pixels, as 16-bit lanes, from the widened left, center
+// and right pixels of the rows above (0), at (1) and below (2).
+__m128i DetectNonEdge8(__m128i l0, __m128i c0, __m128i r0, __m128i l1,
+                       __m128i r1, __m128i l2, __m128i c2, __m128i r2) {
+  const __m128i x_sum = _mm_add_epi16(
+      _mm_add_epi16(_mm_sub_epi16(r0, l0), _mm_sub_epi16(r2, l2)),
+      _mm_slli_epi16(_mm_sub_epi16(r1, l1), 1));
+  const __m128i y_sum = _mm_sub_epi16(
+      _mm_add_epi16(_mm_add_epi16(l0, r0), _mm_slli_epi16(c0, 1)),
+      _mm_add_epi16(_mm_add_epi16(l2, r2), _mm_slli_epi16(c2, 1)));
+
+  // SSE2 has no 16-bit abs or unsigned compare, so use max(x, -x), and test
+  // magnitude > threshold as a non-zero saturating difference.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i max_gradient = _mm_set1_epi16(kMaxGradient);
+  const __m128i x_abs = _mm_min_epi16(
+      _mm_max_epi16(x_sum, _mm_sub_epi16(zero, x_sum)), max_gradient);
+  const __m128i y_abs = _mm_min_epi16(
+      _mm_max_epi16(y_sum, _mm_sub_epi16(zero, y_sum)), max_gradient);
+  const __m128i magnitude = _mm_add_epi16(_mm_mullo_epi16(x_abs, x_abs),
+                                          _mm_mullo_epi16(y_abs, y_abs));
+  return _mm_cmpeq_epi16(
+      _mm_subs_epu16(magnitude, _mm_set1_epi16(kSobelEdgeThreshold)), zero);
+}
+
+inline __m128i Load16(const uint8_t* pixels) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+}
+
+// Writes 16 output pixels starting at pixel.
+void DetectEdge16(const uint8_t* pixel, int32_t stride, uint8_t* out) {
+  const uint8_t* above = pixel - stride;
+  const uint8_t* below = pixel + stride;
+  const __m128i l0 = Load16(above - 1);
+  const __m128i c0 = Load16(above);
+  const __m128i r0 = Load16(above + 1);
+  const __m128i l1 = Load16(pixel - 1);
+  const __m128i r1 = Load16(pixel + 1);
+  const __m128i l2 = Load16(below - 1);
+  const __m128i c2 = Load16(below);
+  const __m128i r2 = Load16(below + 1);
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i non_edge_low = DetectNonEdge8(
+      _mm_unpacklo_epi8(l0, zero), _mm_unpacklo_epi8(c0, zero),
+      _mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(l1, zero),
+      _mm_unpacklo_epi8(r1, zero), _mm_unpacklo_epi8(l2, zero),
+      _mm_unpacklo_epi8(c2, zero), _mm_unpacklo_epi8(r2, zero));
+  const __m128i non_edge_high = DetectNonEdge8(
+      _mm_unpackhi_epi8(l0, zero), _mm_unpackhi_epi8(c0, zero),
+      _mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(l1, zero),
+      _mm_unpackhi_epi8(r1, zero), _mm_unpackhi_epi8(l2, zero),
+      _mm_unpackhi_epi8(c2, zero), _mm_unpackhi_epi8(r2, zero));
+
+  // 0xFF ^ 0xE0 is the non-edge value.
+  const __m128i non_edge = _mm_packs_epi16(non_edge_low, non_edge_high);
+  const __m128i pixels = _mm_xor_si128(
+      _mm_set1_epi8(static_cast<char>(kEdgePixel)),
+      _mm_and_si128(non_edge, _mm_set1_epi8(static_cast<char>(
+                                  kEdgePixel ^ kNonEdgePixel))));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), pixels);
+}
+#endif
+}  // namespace
+
+void DetectEdgeRows(const uint8_t* input, int32_t width, int32_t stride,
+                    int32_t row_begin, int32_t row_end, uint8_t* output) {
+  for (int32_t j = row_begin; j < row_end; ++j) {
+    const uint8_t* input_row = input + j * stride;
+    uint8_t* output_row = output + j * width;
+    int32_t i = 1;
+#if EDGE_DETECTOR_NEON || EDGE_DETECTOR_SSE2
+    // Loads reach one pixel past the last one written, which must stay
+    // within the row.
+    for (; i + kVectorPixels < width; i += kVectorPixels) {
+      DetectEdge16(input_row + i, stride, output_row + i);
+    }
+#endif
+    for (; i < width - 1; ++i) {
+      output_row[i] = DetectEdgePixel(input_row + i, stride);
+    }
+  }
+}
+
+EdgeDetector::~EdgeDetector() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exiting_ = true;
+  }
+  work_cv_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void EdgeDetector::Detect(const uint8_t* input, int32_t width, int32_t height,
+                          int32_t stride, uint8_t* output) {
+  if (height < 3 || width < 3) {
+    return;
+  }
+  const int32_t rows = height - 2;
+  const int32_t tile_count = (rows + kTileRows - 1) / kTileRows;
+  if (!workers_started_ && tile_count > 1) {
+    StartWorkers();
+  }
+
+  // Handing off tiles only pays with another core to run them on.
+  if (tile_count == 1 || workers_.empty()) {
+    DetectEdgeRows(input, width, stride, 1, height - 1, output);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    input_ = input;
+    output_ = output;
+    width_ = width;
+    height_ = height;
+    stride_ = stride;
+    tile_count_ = tile_count;
+    next_tile_.store(0, std::memory_order_relaxed);
+    busy_workers_ = static_cast<int>(workers_.size());
+    generation_++;
+  }
+  work_cv_.notify_all();
+
+  RunTiles();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+}
+
+void EdgeDetector::StartWorkers() {
+  workers_started_ = true;
+  // None on a single core, where they would only add wakeups.
+  const unsigned cores = std::thread::hardware_concurrency();
+  const unsigned worker_count =
+      cores > 1 ? std::min(kMaxWorkers, cores - 1) : 0;
+  for (unsigned i = 0; i < worker_count; ++i) {
+    workers_.emplace_back(&EdgeDetector::WorkerLoop, this);
+  }
+}
+
+void EdgeDetector::WorkerLoop() {
+  uint64_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [this, seen_generation] {
+        return exiting_ || generation_ != seen_generation;
+      });
+      if (exiting_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+
+    RunTiles();
+
+    bool last;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last = --busy_workers_ == 0;
+    }
+    if (last) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+void EdgeDetector::RunTiles() {
+  while (true) {
+    const int32_t tile = next_tile_.fetch_add(1, std::memory_order_relaxed);
+    if (tile >= tile_count_) {
+      return;
+    }
+    const int32_t row_begin = 1 + tile * kTileRows;
+    const int32_t row_end = std::min(row_begin + kTileRows, height_ - 1);
+    DetectEdgeRows(input_, width_, stride_, row_begin, row_end, output_);
+  }
+}
+
+}  // namespace computer_vision
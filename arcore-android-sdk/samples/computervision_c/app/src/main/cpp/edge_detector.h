@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_COMPUTER_VISION_EDGE_DETECTOR_H_
+#define C_ARCORE_COMPUTER_VISION_EDGE_DETECTOR_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace computer_vision {
+
+// Sobel edge detection over rows [row_begin, row_end) of a grayscale image,
+// writing 0xFF for edge pixels and 0x1F otherwise.  The first and last column
+// are not written, and rows must have a row above and below them.  Vectorized
+// with NEON or SSE2 when available, with the same output as the scalar loop.
+//
+// @param input, pixels with stride bytes per row.
+// @param output, pixels with width bytes per row.
+void DetectEdgeRows(const uint8_t* input, int32_t width, int32_t stride,
+                    int32_t row_begin, int32_t row_end, uint8_t* output);
+
+// Runs DetectEdgeRows over a whole image, split into row tiles shared by a
+// small pool of worker threads and the calling thread.  On a single core
+// there are no workers, and the calling thread does the whole image.
+class EdgeDetector {
+ public:
+  EdgeDetector() = default;
+  ~EdgeDetector();
+
+  // Detects edges in all but the border pixels of the image, which are left
+  // untouched.  Blocks until the whole image is done.  Workers are started on
+  // the first call.
+  void Detect(const uint8_t* input, int32_t width, int32_t height,
+              int32_t stride, uint8_t* output);
+
+  // Delete copy constructors.
+  EdgeDetector(const EdgeDetector&) = delete;
+  void operator=(const EdgeDetector&) = delete;
+
+ private:
+  void StartWorkers();
+  void WorkerLoop();
+  // Processes tiles of the current image until none are left.
+  void RunTiles();
+
+  std::vector<std::thread> workers_;
+  bool workers_started_ = false;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  // Guarded by mutex_.
+  uint64_t generation_ = 0;
+  int busy_workers_ = 0;
+  bool exiting_ = false;
+
+  // The current image, set before generation_ is advanced.
+  const uint8_t* input_ = nullptr;
+  uint8_t* output_ = nullptr;
+  int32_t width_ = 0;
+  int32_t height_ = 0;
+  int32_t stride_ = 0;
+  int32_t tile_count_ = 0;
+  std::atomic<int32_t> next_tile_{0};
+};
+
+}  // namespace computer_vision
+#endif  // C_ARCORE_COMPUTER_VISION_EDGE_DETECTOR_H_
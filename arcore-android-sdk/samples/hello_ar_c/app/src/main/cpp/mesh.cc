@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "mesh.h"
+
+#include <cstring>
+
+#include "util.h"
+
+namespace hello_ar {
+namespace {
+constexpr char kMeshFileMagic[4] = {'M', 'E', 'S', 'H'};
+constexpr uint32_t kMeshFileVersion = 1;
+constexpr char kObjExtension[] = ".obj";
+constexpr char kMeshExtension[] = ".mesh";
+}  // namespace
+
+Mesh::~Mesh() { Release(); }
+
+bool Mesh::Load(AAssetManager* asset_manager,
+                const std::string& obj_file_name) {
+  Release();
+
+  const size_t extension_length = strlen(kObjExtension);
+  if (obj_file_name.size() > extension_length &&
+      obj_file_name.compare(obj_file_name.size() - extension_length,
+                            extension_length, kObjExtension) == 0) {
+    const std::string mesh_file_name =
+        obj_file_name.substr(0, obj_file_name.size() - extension_length) +
+        kMeshExtension;
+    if (LoadBinary(asset_manager, mesh_file_name)) {
+      return true;
+    }
+  }
+  return LoadObj(asset_manager, obj_file_name);
+}
+
+bool Mesh::LoadBinary(AAssetManager* asset_manager,
+                      const std::string& file_name) {
+  // AASSET_MODE_BUFFER maps assets stored uncompressed in the APK, which
+  // build.gradle asks for with noCompress.
+  AAsset* asset = AAssetManager_open(asset_manager, file_name.c_str(),
+                                     AASSET_MODE_BUFFER);
+  if (asset == nullptr) {
+    return false;
+  }
+
+  const uint8_t* buffer =
+      static_cast<const uint8_t*>(AAsset_getBuffer(asset));
+  const size_t length = AAsset_getLength(asset);
+  MeshFileHeader header;
+  if (buffer == nullptr || length < sizeof(header) ||
+      reinterpret_cast<uintptr_t>(buffer) % alignof(MeshFileHeader) != 0) {
+    LOGE("Could not map mesh %s", file_name.c_str());
+    AAsset_close(asset);
+    return false;
+  }
+
+  memcpy(&header, buffer, sizeof(header));
+  if (memcmp(header.magic, kMeshFileMagic, sizeof(header.magic)) != 0 ||
+      header.version != kMeshFileVersion ||
+      (header.index_size != sizeof(GLushort) &&
+       header.index_size != sizeof(GLuint)) ||
+      length != sizeof(header) +
+                    static_cast<uint64_t>(header.vertex_count) *
+                        sizeof(Vertex) +
+                    static_cast<uint64_t>(header.index_count) *
+                        header.index_size) {
+    LOGE("Invalid mesh %s, using the OBJ instead.", file_name.c_str());
+    AAsset_close(asset);
+    return false;
+  }
+
+  asset_ = asset;
+  vertices_ = reinterpret_cast<const Vertex*>(buffer + sizeof(header));
+  vertex_count_ = header.vertex_count;
+  indices_ = vertices_ + header.vertex_count;
+  index_count_ = header.index_count;
+  index_type_ = header.index_size == sizeof(GLushort) ? GL_UNSIGNED_SHORT
+                                                       : GL_UNSIGNED_INT;
+  return true;
+}
+
+bool Mesh::LoadObj(AAssetManager* asset_manager,
+                   const std::string& file_name) {
+  std::vector<GLfloat> positions;
+  std::vector<GLfloat> normals;
+  std::vector<GLfloat> uvs;
+  std::vector<GLuint> indices;
+  if (!util::LoadObjFile(file_name, asset_manager, &positions, &normals, &uvs,
+                         &indices)) {
+    LOGE("Could not load mesh %s", file_name.c_str());
+    return false;
+  }
+
+  // LoadObjFile leaves normals and UVs empty when the OBJ has none.
+  const size_t vertex_count = positions.size() / 3;
+  obj_vertices_.resize(vertex_count);
+  for (size_t i = 0; i < vertex_count; ++i) {
+    Vertex& vertex = obj_vertices_[i];
+    memcpy(vertex.position, &positions[i * 3], sizeof(vertex.position));
+    if (normals.empty()) {
+      memset(vertex.normal, 0, sizeof(vertex.normal));
+    } else {
+      memcpy(vertex.normal, &normals[i * 3], sizeof(vertex.normal));
+    }
+    if (uvs.empty()) {
+      memset(vertex.uv, 0, sizeof(vertex.uv));
+    } else {
+      memcpy(vertex.uv, &uvs[i * 2], sizeof(vertex.uv));
+    }
+  }
+
+  vertices_ = obj_vertices_.data();
+  vertex_count_ = vertex_count;
+  index_count_ = indices.size();
+  if (vertex_count <= 65536) {
+    obj_indices16_.assign(indices.begin(), indices.end());
+    indices_ = obj_indices16_.data();
+    index_type_ = GL_UNSIGNED_SHORT;
+  } else {
+    obj_indices32_.swap(indices);
+    indices_ = obj_indices32_.data();
+    index_type_ = GL_UNSIGNED_INT;
+  }
+  return true;
+}
+
+void Mesh::Release() {
+  if (asset_ != nullptr) {
+    AAsset_close(asset_);
+    asset_ = nullptr;
+  }
+  obj_vertices_.clear();
+  obj_indices16_.clear();
+  obj_indices32_.clear();
+  vertices_ = nullptr;
+  vertex_count_ = 0;
+  indices_ = nullptr;
+  index_count_ = 0;
+  index_type_ = GL_UNSIGNED_SHORT;
+}
+
+}  // namespace hello_ar
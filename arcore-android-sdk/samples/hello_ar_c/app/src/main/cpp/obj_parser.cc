@@ -0,0 +1,362 @@
+/*
+ * Copyright 2017 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "obj_parser.h"
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace hello_ar {
+namespace util {
+
+namespace {
+// Reads OBJ text in place, as a replacement for sscanf and atoi that has no
+// line length limit.
+class ObjScanner {
+ public:
+  ObjScanner(const char* begin, const char* end) : cursor_(begin), end_(end) {}
+
+  bool AtEnd() const { return cursor_ == end_; }
+
+  // True at a newline, a comment or the end of the file.
+  bool AtLineEnd() const {
+    return cursor_ == end_ || *cursor_ == '\n' || *cursor_ == '\r' ||
+           *cursor_ == '#';
+  }
+
+  // Skips spaces and tabs, but not newlines.
+  void SkipSpaces() {
+    while (cursor_ != end_ && (*cursor_ == ' ' || *cursor_ == '\t')) {
+      cursor_++;
+    }
+  }
+
+  // Moves past the next newline.
+  void NextLine() {
+    while (cursor_ != end_ && *cursor_++ != '\n') {
+    }
+  }
+
+  // Reads the keyword starting a line, such as "v" or "f".
+  void ReadKeyword(const char** out_begin, size_t* out_length) {
+    SkipSpaces();
+    *out_begin = cursor_;
+    while (cursor_ != end_ && *cursor_ != ' ' && *cursor_ != '\t' &&
+           *cursor_ != '\n' && *cursor_ != '\r') {
+      cursor_++;
+    }
+    *out_length = cursor_ - *out_begin;
+  }
+
+  bool Consume(char c) {
+    if (cursor_ != end_ && *cursor_ == c) {
+      cursor_++;
+      return true;
+    }
+    return false;
+  }
+
+  // Reads a decimal number such as "-1.5e-3" after optional spaces.  Values
+  // are within an ulp of strtof for the digits OBJ exporters write.
+  bool ParseFloat(GLfloat* out) {
+    SkipSpaces();
+    const char* p = cursor_;
+    const bool negative = p != end_ && *p == '-';
+    if (p != end_ && (*p == '-' || *p == '+')) {
+      p++;
+    }
+
+    // Digits past what fits the mantissa only scale it.
+    constexpr uint64_t kMaxMantissa = 100000000000000000ull;
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    bool has_digits = false;
+    for (; p != end_ && IsDigit(*p); ++p) {
+      if (mantissa < kMaxMantissa) {
+        mantissa = mantissa * 10 + (*p - '0');
+      } else {
+        exponent++;
+      }
+      has_digits = true;
+    }
+    if (p != end_ && *p == '.') {
+      for (++p; p != end_ && IsDigit(*p); ++p) {
+        if (mantissa < kMaxMantissa) {
+          mantissa = mantissa * 10 + (*p - '0');
+          exponent--;
+        }
+        has_digits = true;
+      }
+    }
+    if (!has_digits) {
+      return false;
+    }
+
+    if (p != end_ && (*p == 'e' || *p == 'E')) {
+      const char* exponent_begin = p++;
+      const bool negative_exponent = p != end_ && *p == '-';
+      if (p != end_ && (*p == '-' || *p == '+')) {
+        p++;
+      }
+      if (p == end_ || !IsDigit(*p)) {
+        p = exponent_begin;
+      } else {
+        int value = 0;
+        for (; p != end_ && IsDigit(*p); ++p) {
+          if (value < 10000) {
+            value = value * 10 + (*p - '0');
+          }
+        }
+        exponent += negative_exponent ? -value : value;
+      }
+    }
+
+    double value = static_cast<double>(mantissa);
+    if (exponent < 0) {
+      value /= Pow10(-exponent);
+    } else if (exponent > 0) {
+      value *= Pow10(exponent);
+    }
+    *out = static_cast<GLfloat>(negative ? -value : value);
+    cursor_ = p;
+    return true;
+  }
+
+  // Reads a decimal integer with an optional sign.
+  bool ParseInt(int32_t* out) {
+    const char* p = cursor_;
+    const bool negative = p != end_ && *p == '-';
+    if (p != end_ && (*p == '-' || *p == '+')) {
+      p++;
+    }
+    if (p == end_ || !IsDigit(*p)) {
+      return false;
+    }
+    int64_t value = 0;
+    for (; p != end_ && IsDigit(*p); ++p) {
+      if (value <= INT32_MAX) {
+        value = value * 10 + (*p - '0');
+      }
+    }
+    if (value > INT32_MAX) {
+      return false;
+    }
+    *out = static_cast<int32_t>(negative ? -value : value);
+    cursor_ = p;
+    return true;
+  }
+
+ private:
+  static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+  static double Pow10(int exponent) {
+    // Powers of ten that are exact as doubles.
+    static const double kPowers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                     1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                     1e18, 1e19, 1e20, 1e21, 1e22};
+    if (exponent < static_cast<int>(sizeof(kPowers) / sizeof(kPowers[0]))) {
+      return kPowers[exponent];
+    }
+    return std::pow(10.0, exponent);
+  }
+
+  const char* cursor_;
+  const char* const end_;
+};
+
+// A face vertex, as 0-based position, uv and normal indices.
+struct ObjVertexKey {
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  uint32_t position;
+  uint32_t uv;
+  uint32_t normal;
+
+  bool operator==(const ObjVertexKey& other) const {
+    return position == other.position && uv == other.uv &&
+           normal == other.normal;
+  }
+};
+
+struct ObjVertexKeyHash {
+  size_t operator()(const ObjVertexKey& key) const {
+    uint64_t hash = key.position;
+    hash = hash * 0x9E3779B97F4A7C15ull + key.uv;
+    hash = hash * 0x9E3779B97F4A7C15ull + key.normal;
+    return static_cast<size_t>(hash ^ (hash >> 32));
+  }
+};
+
+// Resolves a 1-based, or negative relative, OBJ index to 0-based.
+bool ResolveObjIndex(int32_t index, size_t count, uint32_t* out) {
+  if (index > 0 && static_cast<size_t>(index) <= count) {
+    *out = index - 1;
+  } else if (index < 0 && static_cast<size_t>(-static_cast<int64_t>(index)) <=
+                              count) {
+    *out = static_cast<uint32_t>(count + index);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Reads a face vertex: v, v/vt, v//vn or v/vt/vn.
+bool ParseObjFaceVertex(ObjScanner* scanner, size_t position_count,
+                        size_t uv_count, size_t normal_count,
+                        ObjVertexKey* out) {
+  int32_t index;
+  if (!scanner->ParseInt(&index) ||
+      !ResolveObjIndex(index, position_count, &out->position)) {
+    return false;
+  }
+  out->uv = ObjVertexKey::kNone;
+  out->normal = ObjVertexKey::kNone;
+  if (!scanner->Consume('/')) {
+    return true;
+  }
+  if (!scanner->Consume('/')) {
+    if (!scanner->ParseInt(&index) ||
+        !ResolveObjIndex(index, uv_count, &out->uv)) {
+      return false;
+    }
+    if (!scanner->Consume('/')) {
+      return true;
+    }
+  }
+  return scanner->ParseInt(&index) &&
+         ResolveObjIndex(index, normal_count, &out->normal);
+}
+}  // namespace
+
+bool ParseObj(const char* begin, const char* end,
+              std::vector<GLfloat>* out_vertices,
+              std::vector<GLfloat>* out_normals,
+              std::vector<GLfloat>* out_uv,
+              std::vector<GLuint>* out_indices, int* out_error_line) {
+  ObjScanner scanner(begin, end);
+
+  std::vector<GLfloat> temp_positions;
+  std::vector<GLfloat> temp_normals;
+  std::vector<GLfloat> temp_uvs;
+  std::unordered_map<ObjVertexKey, GLuint, ObjVertexKeyHash> vertex_ids;
+  std::vector<GLuint> face;
+  bool is_normal_available = false;
+  bool is_uv_available = false;
+
+  out_vertices->clear();
+  out_normals->clear();
+  out_uv->clear();
+  out_indices->clear();
+
+  int line_number = 0;
+  bool success = true;
+  for (; success && !scanner.AtEnd(); scanner.NextLine()) {
+    line_number++;
+    const char* keyword;
+    size_t keyword_length;
+    scanner.ReadKeyword(&keyword, &keyword_length);
+
+    if (keyword_length == 2 && keyword[0] == 'v' && keyword[1] == 'n') {
+      // Parse vertex normal.
+      GLfloat normal[3];
+      success = scanner.ParseFloat(&normal[0]) &&
+                scanner.ParseFloat(&normal[1]) &&
+                scanner.ParseFloat(&normal[2]);
+      temp_normals.insert(temp_normals.end(), normal, normal + 3);
+    } else if (keyword_length == 2 && keyword[0] == 'v' && keyword[1] == 't') {
+      // Parse texture uv.
+      GLfloat uv[2];
+      success = scanner.ParseFloat(&uv[0]) && scanner.ParseFloat(&uv[1]);
+      temp_uvs.insert(temp_uvs.end(), uv, uv + 2);
+    } else if (keyword_length == 1 && keyword[0] == 'v') {
+      // Parse vertex.
+      GLfloat vertex[3];
+      success = scanner.ParseFloat(&vertex[0]) &&
+                scanner.ParseFloat(&vertex[1]) &&
+                scanner.ParseFloat(&vertex[2]);
+      temp_positions.insert(temp_positions.end(), vertex, vertex + 3);
+    } else if (keyword_length == 1 && keyword[0] == 'f') {
+      // Vertices shared between faces are only output once.
+      if (vertex_ids.empty()) {
+        vertex_ids.reserve(temp_positions.size() / 3);
+      }
+      face.clear();
+      for (scanner.SkipSpaces(); success && !scanner.AtLineEnd();
+           scanner.SkipSpaces()) {
+        ObjVertexKey key;
+        success = ParseObjFaceVertex(&scanner, temp_positions.size() / 3,
+                                     temp_uvs.size() / 2,
+                                     temp_normals.size() / 3, &key);
+        if (!success) {
+          break;
+        }
+
+        auto inserted = vertex_ids.emplace(
+            key, static_cast<GLuint>(out_vertices->size() / 3));
+        if (inserted.second) {
+          const GLfloat* position = &temp_positions[key.position * 3];
+          out_vertices->insert(out_vertices->end(), position, position + 3);
+          if (key.normal != ObjVertexKey::kNone) {
+            const GLfloat* normal = &temp_normals[key.normal * 3];
+            out_normals->insert(out_normals->end(), normal, normal + 3);
+            is_normal_available = true;
+          } else {
+            out_normals->insert(out_normals->end(), 3, 0.0f);
+          }
+          if (key.uv != ObjVertexKey::kNone) {
+            const GLfloat* uv = &temp_uvs[key.uv * 2];
+            out_uv->insert(out_uv->end(), uv, uv + 2);
+            is_uv_available = true;
+          } else {
+            out_uv->insert(out_uv->end(), 2, 0.0f);
+          }
+        }
+        face.push_back(inserted.first->second);
+      }
+      success = success && face.size() >= 3;
+
+      // Triangulate as a fan.
+      for (size_t i = 2; success && i < face.size(); ++i) {
+        out_indices->push_back(face[0]);
+        out_indices->push_back(face[i - 1]);
+        out_indices->push_back(face[i]);
+      }
+    }
+  }
+
+  if (!success) {
+    if (out_error_line != nullptr) {
+      *out_error_line = line_number;
+    }
+    out_vertices->clear();
+    out_normals->clear();
+    out_uv->clear();
+    out_indices->clear();
+    return false;
+  }
+
+  if (!is_normal_available) {
+    out_normals->clear();
+  }
+  if (!is_uv_available) {
+    out_uv->clear();
+  }
+  return true;
+}
+
+}  // namespace util
+}  // namespace hello_ar
@@ -15,6 +15,8 @@
  */
 
 #include "obj_renderer.h"
+#include <cstddef>
+#include "mesh.h"
 #include "util.h"
 
 namespace hello_ar {
@@ -65,8 +67,42 @@ void ObjRenderer::InitializeGlContent(AAssetManager* asset_manager,
 
   glBindTexture(GL_TEXTURE_2D, 0);
 
-  util::LoadObjFile(obj_file_name, asset_manager, &vertices_, &normals_, &uvs_,
-                    &indices_);
+  // The mesh is only needed until it is in GPU buffers.
+  Mesh mesh;
+  if (mesh.Load(asset_manager, obj_file_name)) {
+    index_count_ = mesh.GetIndexCount();
+    index_type_ = mesh.GetIndexType();
+    const GLsizei index_size =
+        index_type_ == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+
+    glGenBuffers(1, &vertex_buffer_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+    glBufferData(GL_ARRAY_BUFFER, mesh.GetVertexCount() * sizeof(Mesh::Vertex),
+                 mesh.GetVertices(), GL_STATIC_DRAW);
+
+    glGenVertexArrays(1, &vertex_array_);
+    glBindVertexArray(vertex_array_);
+
+    glGenBuffers(1, &index_buffer_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count_ * index_size,
+                 mesh.GetIndices(), GL_STATIC_DRAW);
+
+    const GLsizei stride = sizeof(Mesh::Vertex);
+    glEnableVertexAttribArray(attri_vertices_);
+    glVertexAttribPointer(attri_vertices_, 3, GL_FLOAT, GL_FALSE, stride,
+        reinterpret_cast<const void*>(offsetof(Mesh::Vertex, position)));
+    glEnableVertexAttribArray(attri_normals_);
+    glVertexAttribPointer(attri_normals_, 3, GL_FLOAT, GL_FALSE, stride,
+        reinterpret_cast<const void*>(offsetof(Mesh::Vertex, normal)));
+    glEnableVertexAttribArray(attri_uvs_);
+    glVertexAttribPointer(attri_uvs_, 2, GL_FLOAT, GL_FALSE, stride,
+        reinterpret_cast<const void*>(offsetof(Mesh::Vertex, uv)));
+
+    // The other renderers draw from client memory.
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
 
   util::CheckGlError("obj_renderer::InitializeGlContent()");
 }
@@ -87,6 +123,9 @@ void ObjRenderer::Draw(const glm::mat4& projection_mat,
     LOGE("shader_program is null.");
     return;
   }
+  if (index_count_ == 0) {
+    return;
+  }
 
   glUseProgram(shader_program_);
 
@@ -108,26 +147,9 @@ void ObjRenderer::Draw(const glm::mat4& projection_mat,
   glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
   glUniformMatrix4fv(uniform_mv_mat_, 1, GL_FALSE, glm::value_ptr(mv_mat));
 
-  // Note: for simplicity, we are uploading the model each time we draw it.  A
-  // real application should use vertex buffers to upload the geometry once.
-
-  glEnableVertexAttribArray(attri_vertices_);
-  glVertexAttribPointer(attri_vertices_, 3, GL_FLOAT, GL_FALSE, 0,
-                        vertices_.data());
-
-  glEnableVertexAttribArray(attri_normals_);
-  glVertexAttribPointer(attri_normals_, 3, GL_FLOAT, GL_FALSE, 0,
-                        normals_.data());
-
-  glEnableVertexAttribArray(attri_uvs_);
-  glVertexAttribPointer(attri_uvs_, 2, GL_FLOAT, GL_FALSE, 0, uvs_.data());
-
-  glDrawElements(GL_TRIANGLES, indices_.size(), GL_UNSIGNED_SHORT,
-                 indices_.data());
-
-  glDisableVertexAttribArray(attri_vertices_);
-  glDisableVertexAttribArray(attri_uvs_);
-  glDisableVertexAttribArray(attri_normals_);
+  glBindVertexArray(vertex_array_);
+  glDrawElements(GL_TRIANGLES, index_count_, index_type_, nullptr);
+  glBindVertexArray(0);
 
   glUseProgram(0);
   util::CheckGlError("obj_renderer::Draw()");
@@ -18,6 +18,7 @@
 #define C_ARCORE_HELLOE_AR_OBJ_RENDERER_
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
 #include <android/asset_manager.h>
 #include <cstdint>
 #include <cstdlib>
@@ -35,8 +36,9 @@ class ObjRenderer {
   ObjRenderer() = default;
   ~ObjRenderer() = default;
 
-  // Loads the OBJ file and texture and sets up OpenGL resources used to draw
-  // the model.  Must be called on the OpenGL thread prior to any other calls.
+  // Loads the OBJ file, or the .mesh file converted from it when packaged,
+  // and texture and sets up OpenGL resources used to draw the model.  Must be
+  // called on the OpenGL thread prior to any other calls.
   void InitializeGlContent(AAssetManager* asset_manager,
                            const std::string& obj_file_name,
                            const std::string& png_file_name);
@@ -58,13 +60,13 @@ class ObjRenderer {
   float specular_ = 0.5f;
   float specular_power_ = 6.0f;
 
-  // Model attribute arrays
-  std::vector<GLfloat> vertices_;
-  std::vector<GLfloat> uvs_;
-  std::vector<GLfloat> normals_;
-
-  // Model triangle indices
-  std::vector<GLushort> indices_;
+  // Model interleaved vertices and triangle indices, uploaded once and
+  // bound through vertex_array_
+  GLuint vertex_buffer_ = 0;
+  GLuint index_buffer_ = 0;
+  GLuint vertex_array_ = 0;
+  GLsizei index_count_ = 0;
+  GLenum index_type_ = GL_UNSIGNED_SHORT;
 
   // Loaded TEXTURE_2D object name
   GLuint texture_id_;
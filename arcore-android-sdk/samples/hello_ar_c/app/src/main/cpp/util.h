@@ -113,11 +113,15 @@ bool LoadPngFromAssetManager(int target, const std::string& path);
 // @param out_uv, output texture UV coordinates.
 // @param out_indices, output triangle indices.
 // @return true if obj is loaded correctly, otherwise false.
+//
+// Outputs are replaced, with vertices shared by faces output once.  Normals
+// and UVs are left empty if the OBJ has none, and zero for vertices without
+// them otherwise.
 bool LoadObjFile(const std::string& file_name, AAssetManager* asset_manager,
                  std::vector<GLfloat>* out_vertices,
                  std::vector<GLfloat>* out_normals,
                  std::vector<GLfloat>* out_uv,
-                 std::vector<GLushort>* out_indices);
+                 std::vector<GLuint>* out_indices);
 
 // Format and output the matrix to logcat file.
 // Note that this function output matrix in row major.
@@ -103,7 +103,7 @@ public class HelloArActivity extends AppCompatActivity
 
     // Set up renderer.
     surfaceView.setPreserveEGLContextOnPause(true);
-    surfaceView.setEGLContextClientVersion(2);
+    surfaceView.setEGLContextClientVersion(3);
     surfaceView.setEGLConfigChooser(8, 8, 8, 8, 16, 0); // Alpha used for plane blending.
     surfaceView.setRenderer(this);
     surfaceView.setRenderMode(GLSurfaceView.RENDERMODE_CONTINUOUSLY);
@@ -16,21 +16,19 @@
  
 precision highp float;
 precision highp int;
-attribute vec3 vertex;
+// World space, all planes are drawn in one batch.
+attribute vec3 position;
+attribute float alpha;
+attribute vec3 normal;
 varying vec2 v_textureCoords;
 varying float v_alpha;
 
-uniform mat4 mvp;
-uniform mat4 model_mat;
-uniform vec3 normal;
+uniform mat4 view_projection;
 
 void main() {
-  // Vertex Z value is used as the alpha in this shader.
-  v_alpha = vertex.z;
+  v_alpha = alpha;
 
-  vec4 local_pos = vec4(vertex.x, 0.0, vertex.y, 1.0);
-  gl_Position = mvp * local_pos;
-  vec4 world_pos = model_mat * local_pos;
+  gl_Position = view_projection * vec4(position, 1.0);
 
   // Construct two vectors that are orthogonal to the normal.
   // This arbitrary choice is not co-linear with either horizontal
@@ -41,5 +39,5 @@ void main() {
 
   // Project vertices in world frame onto vec_u and vec_v.
   v_textureCoords = vec2(
-  dot(world_pos.xyz, vec_u), dot(world_pos.xyz, vec_v));
+  dot(position, vec_u), dot(position, vec_v));
 }
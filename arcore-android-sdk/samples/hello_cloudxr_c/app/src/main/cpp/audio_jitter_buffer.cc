@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "audio_jitter_buffer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include "CloudXRLog.h"
+
+namespace hello_ar {
+
+constexpr float AudioJitterBuffer::kMaxRateOffset;
+
+void AudioJitterBuffer::Reset(int32_t sample_rate) {
+  sample_rate_ = sample_rate;
+  write_pos_.store(0);
+  read_pos_.store(0);
+
+  state_ = State::kBuffering;
+  SetTarget(MsToFrames(kInitialTargetMs));
+  fill_average_ = 0.0f;
+  phase_ = 0.0f;
+  gain_ = 0.0f;
+  std::fill(last_, last_ + kChannels, 0.0f);
+  fade_out_left_ = 0;
+  window_frames_ = 0;
+  window_min_fill_ = INT32_MAX;
+  window_underrun_ = false;
+
+  underruns_.store(0);
+  overflow_frames_.store(0);
+  skipped_frames_.store(0);
+}
+
+int32_t AudioJitterBuffer::Write(const int16_t* samples, int32_t frames) {
+  const int64_t write = write_pos_.load(std::memory_order_relaxed);
+  const int64_t read = read_pos_.load(std::memory_order_acquire);
+  const int32_t stored = std::min(frames, kCapacity - static_cast<int32_t>(write - read));
+  if (stored < frames) {
+    overflow_frames_.fetch_add(frames - stored, std::memory_order_relaxed);
+  }
+
+  // Copy in up to two runs, split where the ring wraps.
+  const int32_t offset = static_cast<int32_t>(write & (kCapacity - 1));
+  const int32_t first = std::min(stored, kCapacity - offset);
+  memcpy(&ring_[offset * kChannels], samples, first * kChannels * sizeof(int16_t));
+  memcpy(&ring_[0], samples + first * kChannels,
+         (stored - first) * kChannels * sizeof(int16_t));
+
+  write_pos_.store(write + stored, std::memory_order_release);
+  return stored;
+}
+
+void AudioJitterBuffer::Read(int16_t* out, int32_t frames) {
+  int64_t read = read_pos_.load(std::memory_order_relaxed);
+  int32_t available = static_cast<int32_t>(write_pos_.load(std::memory_order_acquire) - read);
+  fill_average_ += kSmoothing * (available - fill_average_);
+
+  if (state_ == State::kBuffering && available >= target_frames_) {
+    // Fade back in from silence.
+    state_ = State::kPlaying;
+    phase_ = 0.0f;
+    gain_ = 0.0f;
+    fade_out_left_ = 0;
+    fill_average_ = available;
+  }
+
+  if (state_ == State::kPlaying) {
+    window_min_fill_ = std::min(window_min_fill_, available);
+
+    // A burst after a network stall leaves far more than the target.  Skip
+    // it, rather than play it all back late.
+    if (available > target_frames_ + MsToFrames(kMaxTargetMs)) {
+      const int32_t skipped = available - target_frames_;
+      read += skipped;
+      available -= skipped;
+      fill_average_ = available;
+      skipped_frames_.fetch_add(skipped, std::memory_order_relaxed);
+    }
+  }
+
+  // Play slightly faster while above the target, slower while below, so the
+  // fill level follows it however the server and device clocks drift.
+  const float fill_error = (fill_average_ - target_frames_) / target_frames_;
+  const float rate = 1.0f + std::max(-kMaxRateOffset,
+                                     std::min(kRateGain * fill_error, kMaxRateOffset));
+  const float fade_step = 1.0f / MsToFrames(kFadeMs);
+
+  for (int32_t i = 0; i < frames; i++) {
+    int16_t* frame_out = out + i * kChannels;
+
+    // Interpolating needs the frame after the current one too.
+    if (state_ == State::kPlaying && available < 2) {
+      state_ = State::kBuffering;
+      fade_out_left_ = MsToFrames(kFadeMs);
+      window_underrun_ = true;
+      underruns_.fetch_add(1, std::memory_order_relaxed);
+      SetTarget(target_frames_ + MsToFrames(kTargetStepUpMs));
+    }
+
+    if (state_ == State::kPlaying) {
+      const int16_t* a = FrameAt(read);
+      const int16_t* b = FrameAt(read + 1);
+      gain_ = std::min(1.0f, gain_ + fade_step);
+      for (int ch = 0; ch < kChannels; ch++) {
+        last_[ch] = a[ch] + (b[ch] - a[ch]) * phase_;
+        frame_out[ch] = static_cast<int16_t>(lrintf(last_[ch] * gain_));
+      }
+
+      phase_ += rate;
+      const int32_t advance = static_cast<int32_t>(phase_);
+      phase_ -= advance;
+      read += advance;
+      available -= advance;
+    } else if (fade_out_left_ > 0) {
+      // Ran dry, ramp the last sample down instead of cutting to silence.
+      const float gain = fade_out_left_ * fade_step;
+      for (int ch = 0; ch < kChannels; ch++) {
+        frame_out[ch] = static_cast<int16_t>(lrintf(last_[ch] * gain));
+      }
+      fade_out_left_--;
+    } else {
+      std::fill(frame_out, frame_out + kChannels, 0);
+    }
+  }
+
+  read_pos_.store(read, std::memory_order_release);
+
+  // Give latency back once arrival has been steady for a while.
+  window_frames_ += frames;
+  if (window_frames_ >= MsToFrames(kWindowMs)) {
+    if (!window_underrun_ && state_ == State::kPlaying &&
+        window_min_fill_ > MsToFrames(kLowWatermarkMs)) {
+      SetTarget(target_frames_ - MsToFrames(kTargetStepDownMs));
+    }
+    window_frames_ = 0;
+    window_min_fill_ = INT32_MAX;
+    window_underrun_ = false;
+  }
+}
+
+void AudioJitterBuffer::SetTarget(int32_t frames) {
+  target_frames_ = std::max(MsToFrames(kMinTargetMs),
+                            std::min(frames, MsToFrames(kMaxTargetMs)));
+  reported_target_frames_.store(target_frames_, std::memory_order_relaxed);
+}
+
+AudioJitterBuffer::Stats AudioJitterBuffer::GetStats() const {
+  Stats stats;
+  stats.target_frames = reported_target_frames_.load(std::memory_order_relaxed);
+  stats.fill_frames = static_cast<int32_t>(
+      write_pos_.load(std::memory_order_relaxed) -
+      read_pos_.load(std::memory_order_relaxed));
+  stats.underruns = underruns_.load(std::memory_order_relaxed);
+  stats.overflow_frames = overflow_frames_.load(std::memory_order_relaxed);
+  stats.skipped_frames = skipped_frames_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void AudioJitterBuffer::LogReport() {
+  const int64_t fill = write_pos_.load(std::memory_order_relaxed) -
+      read_pos_.load(std::memory_order_relaxed);
+  const float frames_per_ms = sample_rate_ / 1000.0f;
+  CXR_LOGI("Audio jitter buffer: target %.1f ms, fill %.1f ms, underruns %u, "
+           "overflow %u frames, skipped %u frames",
+           reported_target_frames_.load(std::memory_order_relaxed) / frames_per_ms,
+           fill / frames_per_ms,
+           underruns_.exchange(0, std::memory_order_relaxed),
+           overflow_frames_.exchange(0, std::memory_order_relaxed),
+           skipped_frames_.exchange(0, std::memory_order_relaxed));
+}
+
+}  // namespace hello_ar
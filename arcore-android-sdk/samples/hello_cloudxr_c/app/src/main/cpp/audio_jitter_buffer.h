@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_AUDIO_JITTER_BUFFER_H_
+#define C_ARCORE_HELLO_AR_AUDIO_JITTER_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace hello_ar {
+
+// Decouples server audio arriving in network-paced bursts from the audio
+// device pulling it at its own clock, so neither side ever waits on the other.
+//
+// A single producer (the CloudXR audio callback) calls Write() and a single
+// consumer (the Oboe data callback) calls Read(); neither takes a lock.  The
+// consumer keeps the fill level near a target latency that grows after an
+// underrun and shrinks again while arrival is steady, absorbs clock drift
+// between server and device by resampling slightly, and fades out instead of
+// clicking when it runs dry.
+//
+// Samples are interleaved 16-bit stereo.
+class AudioJitterBuffer {
+ public:
+  static constexpr int kChannels = 2;
+  // Ring size in frames, a power of two.
+  static constexpr int32_t kCapacity = 32768;
+
+  AudioJitterBuffer() = default;
+  ~AudioJitterBuffer() = default;
+
+  // Empties the buffer and restarts at the initial target latency.  Call only
+  // while neither Write() nor Read() can run.
+  void Reset(int32_t sample_rate);
+
+  // Producer side.  Frames that don't fit are dropped.
+  // @return the number of frames stored.
+  int32_t Write(const int16_t* samples, int32_t frames);
+
+  // Consumer side, always fills all of out.
+  void Read(int16_t* out, int32_t frames);
+
+  struct Stats {
+    int32_t target_frames;
+    int32_t fill_frames;
+    uint32_t underruns;
+    uint32_t overflow_frames;
+    uint32_t skipped_frames;
+  };
+
+  // Current target latency and fill level, and the counts since the last
+  // LogReport().  Safe to call from any thread.
+  Stats GetStats() const;
+
+  // Logs latency, underruns and dropped frames since the last report.  Safe to
+  // call from any thread.
+  void LogReport();
+
+  // Delete copy constructors.
+  AudioJitterBuffer(const AudioJitterBuffer&) = delete;
+  void operator=(const AudioJitterBuffer&) = delete;
+
+ private:
+  enum class State { kBuffering, kPlaying };
+
+  // Target latency bounds and steps, in milliseconds.
+  static constexpr int32_t kInitialTargetMs = 40;
+  static constexpr int32_t kMinTargetMs = 20;
+  static constexpr int32_t kMaxTargetMs = 200;
+  static constexpr int32_t kTargetStepUpMs = 10;
+  static constexpr int32_t kTargetStepDownMs = 2;
+  // The target shrinks after a window with no underrun in which the fill
+  // level never dropped below this.
+  static constexpr int32_t kLowWatermarkMs = 15;
+  static constexpr int32_t kWindowMs = 2000;
+  // Length of the fades into and out of silence.
+  static constexpr int32_t kFadeMs = 2;
+  // Largest playback rate change for drift correction, and its gain on the
+  // relative fill error.
+  static constexpr float kMaxRateOffset = 0.005f;
+  static constexpr float kRateGain = 0.01f;
+  // Weight of the newest fill level in its running average.
+  static constexpr float kSmoothing = 0.05f;
+
+  int32_t MsToFrames(int32_t ms) const { return ms * sample_rate_ / 1000; }
+  const int16_t* FrameAt(int64_t pos) const {
+    return &ring_[(pos & (kCapacity - 1)) * kChannels];
+  }
+  void SetTarget(int32_t frames);
+
+  int16_t ring_[kCapacity * kChannels] = {};
+  // Frame counters, only ever increasing.  Each is written by one side.
+  std::atomic<int64_t> write_pos_{0};
+  std::atomic<int64_t> read_pos_{0};
+
+  // Consumer state.
+  int32_t sample_rate_ = 48000;
+  State state_ = State::kBuffering;
+  int32_t target_frames_ = 0;
+  float fill_average_ = 0.0f;
+  float phase_ = 0.0f;
+  float gain_ = 0.0f;
+  float last_[kChannels] = {};
+  int32_t fade_out_left_ = 0;
+  int32_t window_frames_ = 0;
+  int32_t window_min_fill_ = 0;
+  bool window_underrun_ = false;
+
+  // Reported by LogReport().
+  std::atomic<int32_t> reported_target_frames_{0};
+  std::atomic<uint32_t> underruns_{0};
+  std::atomic<uint32_t> overflow_frames_{0};
+  std::atomic<uint32_t> skipped_frames_{0};
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_AUDIO_JITTER_BUFFER_H_
@@ -39,9 +39,12 @@
 // This modules handles drawing the passthrough camera image into the OpenGL
 // scene.
 
+#include <algorithm>
+#include <cmath>
 #include <type_traits>
 
 #include "background_renderer.h"
+#include "trace.h"
 
 namespace hello_ar {
 namespace {
@@ -62,6 +65,9 @@ constexpr char kFragmentShaderFilename[] = "shaders/screenquad_ext.frag";
 constexpr char kFragmentShaderFilenameScreen[] = "shaders/screenquad.frag";
 }  // namespace
 
+constexpr int BackgroundRenderer::kQueueLen;
+constexpr int BackgroundRenderer::kMinQueueLen;
+
 void BackgroundRenderer::InitializeGlContent(AAssetManager* asset_manager,
     int width, int height) {
   width_ = width;
@@ -86,25 +92,177 @@ void BackgroundRenderer::InitializeGlContent(AAssetManager* asset_manager,
   glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-  glGenTextures(kQueueLen, texture_ids_);
-  glGenFramebuffers(1, &fbo_);
+  // A new GL context invalidates any textures we had.
+  std::fill(std::begin(texture_ids_), std::end(texture_ids_), 0);
+  std::fill(std::begin(fbo_ids_), std::end(fbo_ids_), 0);
+  queue_len_ = 0;
+  history_dirty_ = true;
+
+  // Both programs sample texture unit 1, which never changes.
+  glUseProgram(shader_program_);
+  glUniform1i(glGetUniformLocation(shader_program_, "sTexture"), 1);
+  glUseProgram(shader_program_screen_);
+  glUniform1i(glGetUniformLocation(shader_program_screen_, "sTexture"), 1);
+  glUseProgram(0);
 
-  for (uint32_t idx = 0; idx < kQueueLen; idx++) {
-    glBindTexture(GL_TEXTURE_2D, texture_ids_[idx]);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glGenBuffers(1, &vertex_buffer_);
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(kVertices), kVertices, GL_STATIC_DRAW);
+
+  glGenBuffers(1, &uv_buffer_);
+  glBindBuffer(GL_ARRAY_BUFFER, uv_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(kUVs), kUVs, GL_STATIC_DRAW);
+
+  // Filled in by Draw() once ARCore reports the display geometry.
+  glGenBuffers(1, &camera_uv_buffer_);
+  glBindBuffer(GL_ARRAY_BUFFER, camera_uv_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(transformed_uvs_), kUVs, GL_DYNAMIC_DRAW);
+  uvs_initialized_ = false;
+
+  camera_vao_ = CreateQuadVertexArray(shader_program_, camera_uv_buffer_);
+  screen_vao_ = CreateQuadVertexArray(shader_program_screen_, uv_buffer_);
+
+  util::CheckGlError("BackgroundRenderer::InitializeGlContent() error");
+}
+
+GLuint BackgroundRenderer::CreateQuadVertexArray(GLuint program,
+                                                 GLuint uv_buffer) const {
+  const GLint attribute_vertices = glGetAttribLocation(program, "a_Position");
+  const GLint attribute_uvs = glGetAttribLocation(program, "a_TexCoord");
+
+  GLuint vao = 0;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+  glEnableVertexAttribArray(attribute_vertices);
+  glVertexAttribPointer(attribute_vertices, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_, 0,
-        GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_ARRAY_BUFFER, uv_buffer);
+  glEnableVertexAttribArray(attribute_uvs);
+  glVertexAttribPointer(attribute_uvs, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+  // Leave default bindings behind for renderers using client-side arrays.
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return vao;
+}
+
+void BackgroundRenderer::SetQueueLength(int length) {
+  length = std::max(kMinQueueLen, std::min(length, kQueueLen));
+  if (length == requested_queue_len_) {
+    return;
   }
 
-  uniform_texture_ = glGetUniformLocation(shader_program_, "sTexture");
-  attribute_vertices_ = glGetAttribLocation(shader_program_, "a_Position");
-  attribute_uvs_ = glGetAttribLocation(shader_program_, "a_TexCoord");
+  CXR_LOGI("Camera look-back queue length %d -> %d frames",
+           requested_queue_len_, length);
+  requested_queue_len_ = length;
 }
 
-void BackgroundRenderer::Draw(const ArSession* session, const ArFrame* frame,
-    int offset) {
+void BackgroundRenderer::SetHistoryStorage(HistoryFormat format, float scale) {
+  scale = std::max(0.25f, std::min(scale, 1.0f));
+  if (format == history_format_ && scale == history_scale_) {
+    return;
+  }
+
+  history_format_ = format;
+  history_scale_ = scale;
+  history_dirty_ = true;
+}
+
+void BackgroundRenderer::AllocateHistory() {
+  if (queue_len_ > 0) {
+    glDeleteFramebuffers(queue_len_, fbo_ids_);
+    glDeleteTextures(queue_len_, texture_ids_);
+    std::fill(std::begin(fbo_ids_), std::end(fbo_ids_), 0);
+    std::fill(std::begin(texture_ids_), std::end(texture_ids_), 0);
+  }
+
+  queue_len_ = requested_queue_len_;
+  history_width_ = std::max(1, (int)std::lround(width_ * history_scale_));
+  history_height_ = std::max(1, (int)std::lround(height_ * history_scale_));
+
+  glGenTextures(queue_len_, texture_ids_);
+  glGenFramebuffers(queue_len_, fbo_ids_);
+  for (int idx = 0; idx < queue_len_; idx++) {
+    CreateHistorySlot(idx);
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  current_texture_ = 0;
+  valid_frames_ = 0;
+  history_dirty_ = false;
+
+  const bool rgb565 = history_format_ == HistoryFormat::kRGB565;
+  CXR_LOGI("Camera look-back queue: %d x %dx%d %s (%d KB)", queue_len_,
+           history_width_, history_height_, rgb565 ? "RGB565" : "RGBA8888",
+           queue_len_ * history_width_ * history_height_ * (rgb565 ? 2 : 4) / 1024);
+  util::CheckGlError("BackgroundRenderer::AllocateHistory() error");
+}
+
+void BackgroundRenderer::ResizeHistory() {
+  const int new_len = requested_queue_len_;
+
+  // Move the images we keep to the front of the arrays, oldest first, and
+  // the rest of the old slots behind them for reuse.
+  const int keep = std::min(valid_frames_, new_len);
+  GLuint textures[kQueueLen];
+  GLuint fbos[kQueueLen];
+  for (int i = 0; i < queue_len_; i++) {
+    const int idx = (current_texture_ - keep + i + queue_len_) % queue_len_;
+    textures[i] = texture_ids_[idx];
+    fbos[i] = fbo_ids_[idx];
+  }
+  std::copy(textures, textures + queue_len_, texture_ids_);
+  std::copy(fbos, fbos + queue_len_, fbo_ids_);
+
+  if (new_len < queue_len_) {
+    glDeleteFramebuffers(queue_len_ - new_len, fbo_ids_ + new_len);
+    glDeleteTextures(queue_len_ - new_len, texture_ids_ + new_len);
+    std::fill(fbo_ids_ + new_len, fbo_ids_ + queue_len_, 0);
+    std::fill(texture_ids_ + new_len, texture_ids_ + queue_len_, 0);
+  } else if (new_len > queue_len_) {
+    glGenTextures(new_len - queue_len_, texture_ids_ + queue_len_);
+    glGenFramebuffers(new_len - queue_len_, fbo_ids_ + queue_len_);
+    for (int idx = queue_len_; idx < new_len; idx++) {
+      CreateHistorySlot(idx);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  CXR_LOGI("Camera look-back queue resized %d -> %d, kept %d frames",
+           queue_len_, new_len, keep);
+  queue_len_ = new_len;
+  current_texture_ = keep % queue_len_;
+  valid_frames_ = keep;
+  util::CheckGlError("BackgroundRenderer::ResizeHistory() error");
+}
+
+void BackgroundRenderer::CreateHistorySlot(int idx) {
+  // RGB565 is color-renderable on GLES3, and halves the memory of RGBA8888.
+  const bool rgb565 = history_format_ == HistoryFormat::kRGB565;
+  const GLenum format = rgb565 ? GL_RGB : GL_RGBA;
+  const GLenum type = rgb565 ? GL_UNSIGNED_SHORT_5_6_5 : GL_UNSIGNED_BYTE;
+
+  glBindTexture(GL_TEXTURE_2D, texture_ids_[idx]);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  glTexImage2D(GL_TEXTURE_2D, 0, format, history_width_, history_height_, 0,
+      format, type, nullptr);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_ids_[idx]);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+      GL_TEXTURE_2D, texture_ids_[idx], 0);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    CXR_LOGE("Camera look-back framebuffer %d is incomplete.", idx);
+  }
+}
+
+bool BackgroundRenderer::UpdateForFrame(const ArSession* session,
+                                        const ArFrame* frame) {
   static_assert(std::extent<decltype(kVertices)>::value == kNumVertices * 2,
                 "Incorrect kVertices length");
 
@@ -117,6 +275,10 @@ void BackgroundRenderer::Draw(const ArSession* session, const ArFrame* frame,
         session, frame, AR_COORDINATES_2D_OPENGL_NORMALIZED_DEVICE_COORDINATES,
         kNumVertices, kVertices, AR_COORDINATES_2D_TEXTURE_NORMALIZED,
         transformed_uvs_);
+    glBindBuffer(GL_ARRAY_BUFFER, camera_uv_buffer_);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(transformed_uvs_),
+                    transformed_uvs_);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     uvs_initialized_ = true;
   }
 
@@ -126,53 +288,90 @@ void BackgroundRenderer::Draw(const ArSession* session, const ArFrame* frame,
     // Suppress rendering if the camera did not produce the first frame yet.
     // This is to avoid drawing possible leftover data from previous sessions if
     // the texture is reused.
-    return;
+    return false;
   }
 
-  const bool render_to_screen = offset >= 0;
+  return true;
+}
 
-  glUseProgram(render_to_screen ? shader_program_screen_ : shader_program_);
+void BackgroundRenderer::DrawCamera(const ArSession* session,
+                                    const ArFrame* frame) {
+  TRACE_SCOPE("BackgroundRenderer::DrawCamera");
+  if (!UpdateForFrame(session, frame)) {
+    return;
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glUseProgram(shader_program_);
   glDepthMask(GL_FALSE);
 
-  if (render_to_screen) {
-    // Render to the screen
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-  } else {
-    // Render to internal queue
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-        GL_TEXTURE_2D, texture_ids_[current_texture_], 0);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture_id_);
+  glBindVertexArray(camera_vao_);
+
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, kNumVertices);
+
+  glBindVertexArray(0);
+  glUseProgram(0);
+  glDepthMask(GL_TRUE);
+  util::CheckGlError("BackgroundRenderer::DrawCamera() error");
+}
+
+void BackgroundRenderer::Draw(const ArSession* session, const ArFrame* frame,
+    int offset) {
+  TRACE_SCOPE("BackgroundRenderer::Draw");
+  if (!UpdateForFrame(session, frame)) {
+    return;
+  }
 
-    glViewport(0, 0, width_, height_);
+  const bool render_to_screen = offset >= 0;
+
+  if (!render_to_screen) {
+    if (history_dirty_) {
+      AllocateHistory();
+    } else if (requested_queue_len_ != queue_len_) {
+      ResizeHistory();
+    }
+  }
 
-    current_texture_ = (current_texture_ + 1)%kQueueLen;
+  if (render_to_screen && valid_frames_ == 0) {
+    return;  // nothing queued yet.
   }
 
-  glUniform1i(uniform_texture_, 1);
+  glUseProgram(render_to_screen ? shader_program_screen_ : shader_program_);
+  glDepthMask(GL_FALSE);
   glActiveTexture(GL_TEXTURE1);
 
   if (render_to_screen) {
+    // Render to the screen
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Fall back to the oldest image we have if asked to look back further.
+    offset = std::min(offset, valid_frames_ - 1);
     offset++;
 
     const int idx = current_texture_ < offset ?
-        (kQueueLen + (current_texture_ - offset))%kQueueLen :
-        (current_texture_ - offset)%kQueueLen;
+        (queue_len_ + (current_texture_ - offset))%queue_len_ :
+        (current_texture_ - offset)%queue_len_;
 
     glBindTexture(GL_TEXTURE_2D, texture_ids_[idx]);
+    glBindVertexArray(screen_vao_);
   } else {
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture_id_);
-  }
+    // Render to internal queue
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_ids_[current_texture_]);
+    glViewport(0, 0, history_width_, history_height_);
 
-  glEnableVertexAttribArray(attribute_vertices_);
-  glVertexAttribPointer(attribute_vertices_, 2, GL_FLOAT, GL_FALSE, 0,
-                        kVertices);
+    current_texture_ = (current_texture_ + 1)%queue_len_;
+    frame_count_++;
+    valid_frames_ = std::min(valid_frames_ + 1, queue_len_);
 
-  glEnableVertexAttribArray(attribute_uvs_);
-  glVertexAttribPointer(attribute_uvs_, 2, GL_FLOAT, GL_FALSE, 0,
-                        offset >= 0 ? kUVs : transformed_uvs_);
+    glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture_id_);
+    glBindVertexArray(camera_vao_);
+  }
 
-  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, kNumVertices);
 
+  glBindVertexArray(0);
   glUseProgram(0);
   glDepthMask(GL_TRUE);
   util::CheckGlError("BackgroundRenderer::Draw() error");
@@ -41,7 +41,9 @@
 
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
 #include <android/asset_manager.h>
+#include <cstdint>
 #include <cstdlib>
 
 #include "arcore_c_api.h"
@@ -52,7 +54,15 @@ namespace hello_ar {
 // This class renders the passthrough camera image into the OpenGL frame.
 class BackgroundRenderer {
  public:
+  // Maximum and minimum number of camera images in the look-back queue.
   static constexpr int kQueueLen = 16;
+  static constexpr int kMinQueueLen = 2;
+
+  // Storage format of the camera images kept in the look-back queue.
+  enum class HistoryFormat {
+    kRGBA8888,
+    kRGB565,
+  };
 
   BackgroundRenderer() = default;
   ~BackgroundRenderer() = default;
@@ -64,30 +74,89 @@ class BackgroundRenderer {
   // Draws the background image.  This methods must be called for every ArFrame
   // returned by ArSession_update() to catch display geometry change events.
   //
-  // Maintains internal look-back circular array of camera images of kQueueLen length.
+  // Maintains internal look-back circular array of camera images, see
+  // SetQueueLength().
   // frame_offset is an offset from the current pointer in camera images array.
   // When image_offset < 0 draws image to the internal array and advances the
   // array pointer.
   void Draw(const ArSession* session, const ArFrame* frame, int frame_offset=-1);
 
+  // Draws the current camera image straight to the screen, bypassing the
+  // look-back queue.  Used while there are no streamed frames to match.
+  void DrawCamera(const ArSession* session, const ArFrame* frame);
+
+  // Sets how many camera images the look-back queue keeps, clamped to
+  // [kMinQueueLen, kQueueLen].  Only that many textures are allocated.
+  // Takes effect on the next queue Draw(), which keeps the newest queued
+  // images, and only allocates or frees the slots added or removed.
+  void SetQueueLength(int length);
+  int GetQueueLength() const { return requested_queue_len_; }
+
+  // Sets how look-back images are stored.  scale shrinks both dimensions
+  // relative to the camera image.  Takes effect on the next queue Draw(),
+  // which drops the queued images.
+  void SetHistoryStorage(HistoryFormat format, float scale);
+
   // Returns the generated texture name for the GL_TEXTURE_EXTERNAL_OES target.
   GLuint GetTextureId() const;
 
+  // Returns the number of camera images copied into the look-back queue so far.
+  // The image drawn with frame_offset 0 is frame number GetFrameCount().
+  uint64_t GetFrameCount() const { return frame_count_; }
+
  private:
   static constexpr int kNumVertices = 4;
 
+  // Picks up display geometry changes for this frame.
+  // @return false if the camera has not produced an image yet.
+  bool UpdateForFrame(const ArSession* session, const ArFrame* frame);
+
+  // (Re)creates the look-back textures, and a framebuffer for each of them,
+  // for the requested length and storage.
+  void AllocateHistory();
+
+  // Changes the queue to the requested length without touching the storage
+  // of the images it keeps.
+  void ResizeHistory();
+
+  // Creates the texture and framebuffer of queue slot idx.
+  void CreateHistorySlot(int idx);
+
+  // Creates a vertex array feeding the quad to program, with UVs from
+  // uv_buffer.
+  GLuint CreateQuadVertexArray(GLuint program, GLuint uv_buffer) const;
+
   GLuint shader_program_;
   GLuint shader_program_screen_;
 
   GLuint texture_id_;
-  GLuint fbo_;
 
-  GLuint texture_ids_[kQueueLen];
+  // One framebuffer per queue slot, so copying a camera image into the queue
+  // never re-attaches textures.
+  GLuint texture_ids_[kQueueLen] = {};
+  GLuint fbo_ids_[kQueueLen] = {};
   int current_texture_ = 0;
-
-  GLuint attribute_vertices_;
-  GLuint attribute_uvs_;
-  GLuint uniform_texture_;
+  uint64_t frame_count_ = 0;
+
+  int queue_len_ = 0;
+  int requested_queue_len_ = kQueueLen;
+  // Number of queue slots written since the queue was last (re)allocated.
+  int valid_frames_ = 0;
+
+  HistoryFormat history_format_ = HistoryFormat::kRGBA8888;
+  float history_scale_ = 1.0f;
+  int history_width_ = 1920;
+  int history_height_ = 1080;
+  bool history_dirty_ = true;
+
+  // Quad geometry is kept in buffers, with one vertex array per program:
+  // camera_vao_ samples the camera texture through the display-rotated UVs,
+  // screen_vao_ samples a queue slot through plain UVs.
+  GLuint vertex_buffer_ = 0;
+  GLuint uv_buffer_ = 0;
+  GLuint camera_uv_buffer_ = 0;
+  GLuint camera_vao_ = 0;
+  GLuint screen_vao_ = 0;
 
   int width_ = 1920;
   int height_ = 1080;
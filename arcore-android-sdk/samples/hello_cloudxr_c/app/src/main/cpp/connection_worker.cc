@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "connection_worker.h"
+
+#include <chrono>
+
+#include "CloudXRLog.h"
+
+namespace hello_ar {
+
+constexpr int ConnectionWorker::kReconnectDelayMs;
+
+ConnectionWorker::ConnectionWorker(Steps steps) : steps_(std::move(steps)) {}
+
+ConnectionWorker::~ConnectionWorker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  Join();
+}
+
+bool ConnectionWorker::Start() {
+  State expected = State::kIdle;
+  if (!state_.compare_exchange_strong(expected, State::kCreating)) {
+    return false;
+  }
+
+  // A worker left over from a failed attempt has already finished.
+  Join();
+  stopping_ = false;
+  last_error_ = cxrError_Success;
+  if (steps_.prepare) {
+    steps_.prepare();
+  }
+  worker_ = std::thread(&ConnectionWorker::Run, this, false);
+  return true;
+}
+
+void ConnectionWorker::OnConnectionLost() {
+  Reconnect("Connection lost");
+}
+
+void ConnectionWorker::Renegotiate() {
+  Reconnect("Stream setup changed");
+}
+
+void ConnectionWorker::Reconnect(const char* reason) {
+  State expected = State::kStreaming;
+  if (!state_.compare_exchange_strong(expected, State::kReconnecting)) {
+    return;
+  }
+
+  CXR_LOGI("%s, reconnecting...", reason);
+  Join();
+  if (steps_.prepare) {
+    steps_.prepare();
+  }
+  worker_ = std::thread(&ConnectionWorker::Run, this, true);
+}
+
+void ConnectionWorker::OnConnectResult(cxrError result) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connect_pending_) {
+      return;
+    }
+    connect_result_ = result;
+    connect_pending_ = false;
+  }
+  wake_.notify_all();
+}
+
+void ConnectionWorker::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  Join();
+  steps_.destroy();
+  SetState(State::kIdle);
+}
+
+const char* ConnectionWorker::StateName(State state) {
+  switch (state) {
+    case State::kIdle: return "Idle";
+    case State::kCreating: return "Creating";
+    case State::kConnecting: return "Connecting";
+    case State::kStreaming: return "Streaming";
+    case State::kReconnecting: return "Reconnecting";
+  }
+  return "Unknown";
+}
+
+void ConnectionWorker::Run(bool reconnect) {
+  const int max_attempts = reconnect ? kMaxReconnectAttempts : 1;
+
+  cxrError err = cxrError_Success;
+  for (int attempt = 0; attempt < max_attempts && !stopping_; ++attempt) {
+    if (attempt > 0 && !Sleep(kReconnectDelayMs << (attempt - 1))) {
+      return;
+    }
+
+    err = Attempt(reconnect);
+    if (stopping_) {
+      // Stop() owns the state from here.
+      return;
+    }
+    if (err == cxrError_Success) {
+      SetState(State::kStreaming);
+      return;
+    }
+  }
+
+  // Leave the error for the render loop to act on.
+  if (!stopping_) {
+    last_error_ = err;
+    SetState(State::kIdle);
+  }
+}
+
+cxrError ConnectionWorker::Attempt(bool reconnect) {
+  if (reconnect) {
+    // A dropped receiver can't be reconnected, start over with a new one.
+    steps_.destroy();
+  }
+
+  SetState(reconnect ? State::kReconnecting : State::kCreating);
+  cxrError err = steps_.create();
+  if (err != cxrError_Success || stopping_) {
+    return err;
+  }
+
+  if (!reconnect) {
+    SetState(State::kConnecting);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connect_pending_ = true;
+  }
+  err = steps_.connect();
+  if (err != cxrError_Success) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connect_pending_ = false;
+    return err;
+  }
+  return WaitForConnectResult();
+}
+
+bool ConnectionWorker::Sleep(int delay_ms) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return !wake_.wait_for(lock, std::chrono::milliseconds(delay_ms),
+                         [this]() { return stopping_.load(); });
+}
+
+cxrError ConnectionWorker::WaitForConnectResult() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  wake_.wait(lock, [this]() { return !connect_pending_ || stopping_; });
+  // Stop() leaves the result pending, Run() bails out on stopping_ instead.
+  connect_pending_ = false;
+  return connect_result_;
+}
+
+void ConnectionWorker::SetState(State state) {
+  const State previous = state_.exchange(state, std::memory_order_acq_rel);
+  if (previous != state) {
+    CXR_LOGI("Connection state: %s -> %s", StateName(previous),
+             StateName(state));
+  }
+}
+
+void ConnectionWorker::Join() {
+  if (worker_.joinable() && worker_.get_id() != std::this_thread::get_id()) {
+    worker_.join();
+  }
+}
+
+}  // namespace hello_ar
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_CONNECTION_WORKER_H_
+#define C_ARCORE_HELLO_AR_CONNECTION_WORKER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "CloudXRCommon.h"
+
+namespace hello_ar {
+
+// Runs CloudXR receiver creation and connection on a worker thread, so the
+// render loop never blocks on them and only polls GetState().
+//
+// The receiver itself is driven through Steps, which keeps this state machine
+// free of any CloudXR or GL calls.  Connecting is asynchronous: connect only
+// starts it, and the outcome comes back through OnConnectResult().  Nothing
+// the worker waits on blocks Stop() for longer than receiver creation.
+class ConnectionWorker {
+ public:
+  enum class State {
+    kIdle,          // not connected, see GetLastError() for why
+    kCreating,      // creating the receiver and audio streams
+    kConnecting,    // receiver created, connecting to the server
+    kStreaming,     // connected
+    kReconnecting,  // connection lost, recreating and connecting again
+  };
+
+  struct Steps {
+    // Captures whatever create and connect need from the caller's thread.
+    // Called on the thread calling Start() or reconnecting, before the worker
+    // starts.  Optional.
+    std::function<void()> prepare;
+    // Creates the receiver.  Called on the worker thread.
+    std::function<cxrError()> create;
+    // Starts connecting the receiver to the server, and reports the outcome
+    // through OnConnectResult(), from any thread.  Called on the worker
+    // thread.
+    std::function<cxrError()> connect;
+    // Destroys the receiver, if any.  Called on the worker thread before
+    // reconnecting, or on the caller's thread from Stop().
+    std::function<void()> destroy;
+  };
+
+  explicit ConnectionWorker(Steps steps);
+  ~ConnectionWorker();
+
+  // Starts creating and connecting from kIdle.
+  // @return false if a connection is already underway or established.
+  bool Start();
+
+  // Reports a dropped connection while kStreaming, and starts reconnecting.
+  void OnConnectionLost();
+
+  // Reconnects while kStreaming, so a changed stream setup takes effect.
+  void Renegotiate();
+
+  // Reports how the connection started by Steps::connect turned out.  Ignored
+  // unless the worker is waiting for it.
+  void OnConnectResult(cxrError result);
+
+  // Stops the worker, destroys the receiver and returns to kIdle.  Waiting
+  // for a connection or between reconnect attempts is cut short, so this only
+  // blocks while a receiver is being created.
+  void Stop();
+
+  State GetState() const { return state_.load(std::memory_order_acquire); }
+
+  // The error that sent the worker back to kIdle, or cxrError_Success.
+  cxrError GetLastError() const {
+    return last_error_.load(std::memory_order_acquire);
+  }
+
+  static const char* StateName(State state);
+
+  // Delete copy constructors.
+  ConnectionWorker(const ConnectionWorker&) = delete;
+  void operator=(const ConnectionWorker&) = delete;
+
+ private:
+  static constexpr int kMaxReconnectAttempts = 3;
+  // Doubles after every failed reconnect attempt.
+  static constexpr int kReconnectDelayMs = 500;
+
+  void Reconnect(const char* reason);
+  void Run(bool reconnect);
+  cxrError Attempt(bool reconnect);
+  // Sleeps for delay_ms unless stopped first.
+  // @return false if stopped.
+  bool Sleep(int delay_ms);
+  // Waits for OnConnectResult() or Stop().
+  cxrError WaitForConnectResult();
+  void SetState(State state);
+  void Join();
+
+  const Steps steps_;
+  std::thread worker_;
+  std::atomic<State> state_{State::kIdle};
+  std::atomic<cxrError> last_error_{cxrError_Success};
+  std::atomic<bool> stopping_{false};
+
+  // Guards the connect result, and wakes the worker on Stop().
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool connect_pending_ = false;
+  cxrError connect_result_ = cxrError_Success;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_CONNECTION_WORKER_H_
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CloudXRLog.h"
+
+namespace hello_ar {
+
+constexpr uint32_t FramePacer::kMaxLatchTimeoutMs;
+
+void FramePacer::Reset(float stream_fps) {
+  last_latch_us_ = 0;
+  interval_us_ = 1000000.0f / std::max(stream_fps, 1.0f);
+  jitter_us_ = 0.0f;
+  latched_frames_ = 0;
+  held_frames_ = 0;
+  missed_frames_ = 0;
+}
+
+bool FramePacer::IsFrameDue(int64_t now_us) const {
+  if (last_latch_us_ == 0) {
+    return true;
+  }
+  // We only get to look once per display frame, so allow a frame to come a
+  // little early rather than holding the old one for a whole display frame.
+  const float early_us = std::max(jitter_us_, kEarlyFraction * interval_us_);
+  return now_us - last_latch_us_ >= static_cast<int64_t>(interval_us_ - early_us);
+}
+
+uint32_t FramePacer::GetLatchTimeoutMs(int64_t now_us) const {
+  if (!IsFrameDue(now_us)) {
+    return 0;
+  }
+
+  // Wait out the usual lateness of a frame, but no more than that, a frame
+  // later than that can be picked up next display frame.
+  const float timeout_ms = 2.0f * jitter_us_ / 1000.0f;
+  return std::min(static_cast<uint32_t>(std::ceil(timeout_ms)),
+                  kMaxLatchTimeoutMs);
+}
+
+void FramePacer::OnFrameLatched(int64_t now_us) {
+  latched_frames_++;
+
+  if (last_latch_us_ != 0) {
+    const float delta_us = static_cast<float>(now_us - last_latch_us_);
+    if (delta_us < kMaxIntervalRatio * interval_us_) {
+      jitter_us_ += kSmoothing * (std::fabs(delta_us - interval_us_) - jitter_us_);
+      interval_us_ += kSmoothing * (delta_us - interval_us_);
+    }
+  }
+  last_latch_us_ = now_us;
+}
+
+void FramePacer::LogReport() {
+  CXR_LOGI("Frame pacing: interval %.1f ms, jitter %.1f ms, "
+           "latched %u, held %u, missed %u",
+           interval_us_ / 1000.0f, jitter_us_ / 1000.0f,
+           latched_frames_, held_frames_, missed_frames_);
+
+  latched_frames_ = 0;
+  held_frames_ = 0;
+  missed_frames_ = 0;
+}
+
+}  // namespace hello_ar
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_FRAME_PACER_H_
+#define C_ARCORE_HELLO_AR_FRAME_PACER_H_
+
+#include <cstdint>
+
+namespace hello_ar {
+
+// Predicts when the next streamed frame will be ready to latch, from a
+// smoothed average of recent inter-arrival times, so the render loop can keep
+// showing the frame it has instead of blocking in cxrLatchFrame.
+//
+// Times are in microseconds from util::NowUs().  Not thread safe, use from the GL
+// thread only.
+class FramePacer {
+ public:
+  FramePacer() = default;
+  ~FramePacer() = default;
+
+  // Forgets the arrival history, and seeds the prediction from the stream fps.
+  void Reset(float stream_fps);
+
+  // @return true once the next frame is expected, so the held one should be
+  // released and a new one latched.
+  bool IsFrameDue(int64_t now_us) const;
+
+  // @return how long cxrLatchFrame may wait for a frame that is due.  This is
+  // short, covering the arrival jitter, and zero while no frame is expected.
+  uint32_t GetLatchTimeoutMs(int64_t now_us) const;
+
+  void OnFrameLatched(int64_t now_us);
+  void OnFrameMissed() { missed_frames_++; }
+  void OnFrameHeld() { held_frames_++; }
+
+  // Logs the predicted interval, jitter and frame counts since the last report.
+  void LogReport();
+
+ private:
+  // Weight of the newest sample in the running averages.
+  static constexpr float kSmoothing = 0.1f;
+  // Upper bound on any latch wait, a fraction of a 60Hz display frame.
+  static constexpr uint32_t kMaxLatchTimeoutMs = 4;
+  // Fraction of an interval a frame may be due ahead of the prediction.
+  static constexpr float kEarlyFraction = 0.25f;
+  // Arrival gaps longer than this many intervals are dropouts, not pacing.
+  static constexpr float kMaxIntervalRatio = 3.0f;
+
+  int64_t last_latch_us_ = 0;
+  float interval_us_ = 1000000.0f / 60.0f;
+  float jitter_us_ = 0.0f;
+
+  uint32_t latched_frames_ = 0;
+  uint32_t held_frames_ = 0;
+  uint32_t missed_frames_ = 0;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_FRAME_PACER_H_
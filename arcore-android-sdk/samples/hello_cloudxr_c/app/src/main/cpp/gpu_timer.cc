@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gpu_timer.h"
+
+#include <EGL/egl.h>
+#include <cstring>
+
+#include "util.h"
+
+namespace hello_ar {
+
+void GpuTimer::InitializeGlContent() {
+  // Any queries from a previous context are gone with it.
+  num_stages_ = 0;
+  for (Stage& stage : stages_) {
+    stage = Stage();
+  }
+
+  const char* extensions =
+      reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+  supported_ = extensions &&
+      strstr(extensions, "GL_EXT_disjoint_timer_query") != nullptr;
+
+  if (supported_) {
+    glGenQueriesEXT_ = reinterpret_cast<PFNGLGENQUERIESEXTPROC>(
+        eglGetProcAddress("glGenQueriesEXT"));
+    glBeginQueryEXT_ = reinterpret_cast<PFNGLBEGINQUERYEXTPROC>(
+        eglGetProcAddress("glBeginQueryEXT"));
+    glEndQueryEXT_ = reinterpret_cast<PFNGLENDQUERYEXTPROC>(
+        eglGetProcAddress("glEndQueryEXT"));
+    glGetQueryObjectuivEXT_ = reinterpret_cast<PFNGLGETQUERYOBJECTUIVEXTPROC>(
+        eglGetProcAddress("glGetQueryObjectuivEXT"));
+    glGetQueryObjectui64vEXT_ =
+        reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(
+            eglGetProcAddress("glGetQueryObjectui64vEXT"));
+
+    supported_ = glGenQueriesEXT_ && glBeginQueryEXT_ && glEndQueryEXT_ &&
+        glGetQueryObjectuivEXT_ && glGetQueryObjectui64vEXT_;
+  }
+
+  CXR_LOGI("GPU stage timing %s.", supported_ ? "enabled" : "not supported");
+}
+
+int GpuTimer::AddStage(const char* name) {
+  if (!supported_ || num_stages_ >= kMaxStages) {
+    return -1;
+  }
+
+  Stage& stage = stages_[num_stages_];
+  stage.name = name;
+  glGenQueriesEXT_(kQueriesPerStage, stage.queries);
+  return num_stages_++;
+}
+
+void GpuTimer::Begin(int stage_id) {
+  if (stage_id < 0 || stage_id >= num_stages_) {
+    return;
+  }
+
+  Stage& stage = stages_[stage_id];
+  // All queries still in flight, skip this sample rather than stall.
+  if (stage.issued - stage.collected >= kQueriesPerStage) {
+    return;
+  }
+
+  glBeginQueryEXT_(GL_TIME_ELAPSED_EXT,
+                   stage.queries[stage.issued % kQueriesPerStage]);
+  stage.active = true;
+}
+
+void GpuTimer::End(int stage_id) {
+  if (stage_id < 0 || stage_id >= num_stages_ || !stages_[stage_id].active) {
+    return;
+  }
+
+  Stage& stage = stages_[stage_id];
+  glEndQueryEXT_(GL_TIME_ELAPSED_EXT);
+  stage.issued++;
+  stage.active = false;
+}
+
+void GpuTimer::Update() {
+  if (!supported_) {
+    return;
+  }
+
+  // A disjoint event (e.g. a clock change) invalidates results in flight.
+  GLint disjoint = 0;
+  glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+  for (int i = 0; i < num_stages_; ++i) {
+    Stage& stage = stages_[i];
+    while (stage.collected != stage.issued) {
+      const GLuint query = stage.queries[stage.collected % kQueriesPerStage];
+
+      GLuint available = 0;
+      glGetQueryObjectuivEXT_(query, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+      if (!available) {
+        break;
+      }
+
+      GLuint64 elapsed_ns = 0;
+      glGetQueryObjectui64vEXT_(query, GL_QUERY_RESULT_EXT, &elapsed_ns);
+      stage.collected++;
+
+      if (!disjoint) {
+        stage.total_ns += elapsed_ns;
+        stage.max_ns = elapsed_ns > stage.max_ns ? elapsed_ns : stage.max_ns;
+        stage.samples++;
+      }
+    }
+  }
+}
+
+void GpuTimer::LogReport() {
+  for (int i = 0; i < num_stages_; ++i) {
+    Stage& stage = stages_[i];
+    if (stage.samples == 0) {
+      continue;
+    }
+
+    CXR_LOGI("GPU %s: avg %.3f ms, max %.3f ms (%u frames)", stage.name,
+             stage.total_ns / (stage.samples * 1e6), stage.max_ns / 1e6,
+             stage.samples);
+
+    stage.total_ns = 0;
+    stage.max_ns = 0;
+    stage.samples = 0;
+  }
+}
+
+}  // namespace hello_ar
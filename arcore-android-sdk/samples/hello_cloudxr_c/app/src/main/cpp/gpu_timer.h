@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_GPU_TIMER_H_
+#define C_ARCORE_HELLO_AR_GPU_TIMER_H_
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <cstdint>
+
+namespace hello_ar {
+
+// Measures the GPU time of named render stages with
+// GL_EXT_disjoint_timer_query.  Results are read back a few frames later, so
+// timing never makes the CPU wait on the GPU.  If the extension is missing,
+// all calls are no-ops.
+class GpuTimer {
+ public:
+  static constexpr int kMaxStages = 4;
+
+  GpuTimer() = default;
+  ~GpuTimer() = default;
+
+  // Looks up the timer query extension and drops all stages.  Must be called
+  // on the OpenGL thread before any other methods below.
+  void InitializeGlContent();
+
+  // Registers a named stage.  name must outlive the timer.
+  // @return the stage id to pass to Begin() and End(), or -1 if unavailable.
+  int AddStage(const char* name);
+
+  // Brackets the GL commands of a stage.  Stages must not nest.
+  void Begin(int stage);
+  void End(int stage);
+
+  // Collects finished queries without blocking.  Call once per frame.
+  void Update();
+
+  // Logs the average and worst GPU time of each stage since the last report.
+  void LogReport();
+
+ private:
+  // How many frames a result may take to come back before we skip timing.
+  static constexpr int kQueriesPerStage = 4;
+
+  struct Stage {
+    const char* name = nullptr;
+    GLuint queries[kQueriesPerStage] = {};
+    uint32_t issued = 0;
+    uint32_t collected = 0;
+    bool active = false;
+
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint32_t samples = 0;
+  };
+
+  bool supported_ = false;
+  int num_stages_ = 0;
+  Stage stages_[kMaxStages];
+
+  PFNGLGENQUERIESEXTPROC glGenQueriesEXT_ = nullptr;
+  PFNGLBEGINQUERYEXTPROC glBeginQueryEXT_ = nullptr;
+  PFNGLENDQUERYEXTPROC glEndQueryEXT_ = nullptr;
+  PFNGLGETQUERYOBJECTUIVEXTPROC glGetQueryObjectuivEXT_ = nullptr;
+  PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT_ = nullptr;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_GPU_TIMER_H_
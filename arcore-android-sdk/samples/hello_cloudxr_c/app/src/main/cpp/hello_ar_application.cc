@@ -40,13 +40,23 @@
 #include "CloudXRFileLogger.h"
 
 #include <android/asset_manager.h>
+#include <algorithm>
 #include <array>
-#include <mutex>
 #include <EGL/egl.h>
 
 #include "oboe/Oboe.h"
 
+#include "audio_jitter_buffer.h"
+#include "connection_worker.h"
+#include "frame_pacer.h"
+#include "latency_tracker.h"
+#include "light_filter.h"
+#include "mic_uplink.h"
 #include "plane_renderer.h"
+#include "pose_history.h"
+#include "resolution_controller.h"
+#include "stats_collector.h"
+#include "trace.h"
 #include "util.h"
 
 #include "CloudXRClient.h"
@@ -67,19 +77,46 @@
 namespace hello_ar {
 namespace {
 const glm::vec3 kWhite = {255, 255, 255};
+
+// Only shrink the camera look-back queue once it is this many frames deeper
+// than needed, so small latency swings don't reallocate it.
+constexpr int kCameraQueueShrinkSlack = 2;
+
+// Keep copying new stream frames into the frame cache for this long after a
+// frame came late.  A stream that stays on time is blitted straight to the
+// screen.
+constexpr int64_t kHoldFrameArmUs = 2000000;
 }  // namespace
 
 class ARLaunchOptions : public CloudXR::ClientOptions {
 public:
     bool using_env_lighting_;
     float res_factor_;
+    bool adaptive_res_;
+    int history_frames_;
+    BackgroundRenderer::HistoryFormat history_format_;
+    float history_scale_;
+    StreamFrameCache::HoldMode hold_mode_;
+    bool late_reprojection_;
+    bool mic_vad_;
+    bool latency_trace_;
+    bool trace_;
 
     ARLaunchOptions() :
       ClientOptions(),
       using_env_lighting_(true), // default ON
       // default to 0.75 reduced size, as many devices can't handle full throughput.
       // 0.75 chosen as WAR value for steamvr buffer-odd-size bug, works on galaxytab s6 + pixel 2
-      res_factor_(0.75f)
+      res_factor_(0.75f),
+      adaptive_res_(false), // default OFF
+      history_frames_(0), // default derive from measured latency
+      history_format_(BackgroundRenderer::HistoryFormat::kRGBA8888),
+      history_scale_(1.0f),
+      hold_mode_(StreamFrameCache::HoldMode::kHold),
+      late_reprojection_(false), // default OFF
+      mic_vad_(true), // default ON
+      latency_trace_(false),
+      trace_(false)
     {
       AddOption("env-lighting", "el", true, "Send client environment lighting data to server.  1 enables, 0 disables.",
                  HANDLER_LAMBDA_FN
@@ -101,6 +138,102 @@ public:
                     CXR_LOGI("Resolution factor = %0.2f", res_factor_);
                     return ParseStatus_Success;
                  });
+      AddOption("history-frames", "hfr", true, "Number of camera frames kept to match streamed frames. 0 derives it from measured latency. Range [0, 2-16].",
+                 HANDLER_LAMBDA_FN
+                 {
+                    int frames = std::stoi(tok);
+                    if (frames == 0 || (frames >= BackgroundRenderer::kMinQueueLen && frames <= BackgroundRenderer::kQueueLen))
+                      history_frames_ = frames;
+                    return ParseStatus_Success;
+                 });
+      AddOption("history-format", "hfmt", true, "Storage format of kept camera frames, rgba or rgb565.",
+                 HANDLER_LAMBDA_FN
+                 {
+                    if (tok=="rgba") {
+                      history_format_ = BackgroundRenderer::HistoryFormat::kRGBA8888;
+                    }
+                    else if (tok=="rgb565") {
+                      history_format_ = BackgroundRenderer::HistoryFormat::kRGB565;
+                    }
+                    return ParseStatus_Success;
+                 });
+      AddOption("history-scale", "hsc", true, "Resolution scale of kept camera frames relative to the camera image. Range [0.25-1.0].",
+                 HANDLER_LAMBDA_FN
+                 {
+                    float scale = std::stof(tok);
+                    if (scale >= 0.25f && scale <= 1.0f)
+                      history_scale_ = scale;
+                    return ParseStatus_Success;
+                 });
+      AddOption("hold-frame", "hold", true, "Redraw the last streamed frame when a new one is late: off, on, or reproject to rotate it to the current view.",
+                 HANDLER_LAMBDA_FN
+                 {
+                    if (tok=="off") {
+                      hold_mode_ = StreamFrameCache::HoldMode::kOff;
+                    }
+                    else if (tok=="on") {
+                      hold_mode_ = StreamFrameCache::HoldMode::kHold;
+                    }
+                    else if (tok=="reproject") {
+                      hold_mode_ = StreamFrameCache::HoldMode::kReproject;
+                    }
+                    return ParseStatus_Success;
+                 });
+      AddOption("adaptive-res", "ar", true, "Lower or raise the stream resolution and bitrate with connection quality, starting from the res-factor.  1 enables, 0 disables.",
+                 HANDLER_LAMBDA_FN
+                 {
+                    if (tok=="1") {
+                      adaptive_res_ = true;
+                    }
+                    else if (tok=="0") {
+                      adaptive_res_ = false;
+                    }
+                    return ParseStatus_Success;
+                 });
+      AddOption("late-reprojection", "lr", true, "Rotate every streamed frame to the latest camera pose, and show the live camera image.  1 enables, 0 disables.",
+                 HANDLER_LAMBDA_FN
+                 {
+                    if (tok=="1") {
+                      late_reprojection_ = true;
+                    }
+                    else if (tok=="0") {
+                      late_reprojection_ = false;
+                    }
+                    return ParseStatus_Success;
+                 });
+      AddOption("mic-vad", "mv", true, "Only send microphone audio while someone is talking.  1 enables, 0 disables.",
+                 HANDLER_LAMBDA_FN
+                 {
+                    if (tok=="1") {
+                      mic_vad_ = true;
+                    }
+                    else if (tok=="0") {
+                      mic_vad_ = false;
+                    }
+                    return ParseStatus_Success;
+                 });
+      AddOption("latency-trace", "lt", true, "Write per-frame pipeline timestamps to latency_trace.bin in the log folder.  1 enables, 0 disables.",
+                 HANDLER_LAMBDA_FN
+                 {
+                    if (tok=="1") {
+                      latency_trace_ = true;
+                    }
+                    else if (tok=="0") {
+                      latency_trace_ = false;
+                    }
+                    return ParseStatus_Success;
+                 });
+      AddOption("trace", "tr", true, "Write a Chrome trace of render, streaming and audio work to trace.json in the log folder.  1 enables, 0 disables.",
+                 HANDLER_LAMBDA_FN
+                 {
+                    if (tok=="1") {
+                      trace_ = true;
+                    }
+                    else if (tok=="0") {
+                      trace_ = false;
+                    }
+                    return ParseStatus_Success;
+                 });
     }
 };
 
@@ -123,11 +256,20 @@ extern "C" void dispatchLogMsg(cxrLogLevel level, cxrMessageCategory category, v
 
 class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
  public:
-    CloudXRClient(const std::string &outputPath) {
+    CloudXRClient(const std::string &outputPath)
+        : mic_uplink_([this](const int16_t* samples, int32_t frames) {
+            cxrAudioFrame packet{};
+            packet.streamBuffer = const_cast<int16_t*>(samples);
+            packet.streamSizeBytes = frames * CXR_AUDIO_CHANNEL_COUNT * CXR_AUDIO_SAMPLE_SIZE;
+            cxrSendAudio(cloudxr_receiver_, &packet);
+          }),
+          connection_({[this]() { connect_device_desc_ = GetDeviceDesc(); },
+                       [this]() { return Init(); },
+                       [this]() { return Connect(); },
+                       [this]() { DestroyReceiver(); }}) {
         outputPath_ = outputPath;
         // just to be clear on state variables...
         cloudxr_receiver_ = nullptr;
-        isStreaming_ = false;
         exiting_ = false;
     }
 
@@ -138,6 +280,25 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
   // CloudXR interface callbacks
   void TriggerHaptic(const cxrHapticFeedback*) {}
 
+  // Reports how the connection started by Connect() is going, on a CloudXR thread.
+  void UpdateClientState(cxrClientState state, cxrError error) {
+    switch (state) {
+      case cxrClientState_StreamingSessionInProgress:
+        CXR_LOGI("Receiver connected to server!");
+        frame_pacer_.Reset(static_cast<float>(fps_));
+        connection_.OnConnectResult(cxrError_Success);
+        break;
+      case cxrClientState_ConnectionAttemptFailed:
+      case cxrClientState_Disconnected:
+        CXR_LOGE("Connection to CloudXR server ended. Error %d, %s.", (int)error, cxrErrorString(error));
+        // only ends a connection attempt, Latch() picks up a drop while streaming.
+        connection_.OnConnectResult(error != cxrError_Success ? error : cxrError_Not_Connected);
+        break;
+      default:
+        break;
+    }
+  }
+
   void GetTrackingState(cxrVRTrackingState* state) {
     *state = {};
 
@@ -146,23 +307,24 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
     state->hmd.pose.trackingResult = cxrTrackingResult_Running_OK;
     state->hmd.activityLevel = cxrDeviceActivityLevel_UserInteraction;
 
-    {
-      std::lock_guard<std::mutex> lock(state_mutex_);
-      const int idx = current_idx_ == 0 ?
-          kQueueLen - 1 : (current_idx_ - 1)%kQueueLen;
-      cxrMatrixToVecQuat(pose_matrix_ + idx, &(state->hmd.pose.position), &(state->hmd.pose.rotation));
-    }
+    // lock-free read, so this callback never stalls the GL thread pushing poses.
+    cxrMatrix34 pose_matrix = {};
+    // the server hands this ID back in cxrFramesLatched, see DetermineOffset().
+    state->poseID = pose_history_.GetLatest(&pose_matrix);
+    latency_tracker_.OnPosePickup(state->poseID, util::NowUs());
+    cxrMatrixToVecQuat(&pose_matrix, &(state->hmd.pose.position), &(state->hmd.pose.rotation));
   }
 
   cxrBool RenderAudio(const cxrAudioFrame *audioFrame)
   {
+    TRACE_SCOPE("RenderAudio");
     if (!playback_stream_ || exiting_) {
       return cxrFalse;
     }
 
-    const uint32_t timeout = audioFrame->streamSizeBytes / CXR_AUDIO_BYTES_PER_MS;
-    const uint32_t numFrames = timeout * CXR_AUDIO_SAMPLING_RATE / 1000;
-    playback_stream_->write(audioFrame->streamBuffer, numFrames, timeout * oboe::kNanosPerMillisecond);
+    // never block here, the playback callback drains the jitter buffer at the device's pace.
+    const uint32_t numFrames = audioFrame->streamSizeBytes / (CXR_AUDIO_CHANNEL_COUNT * CXR_AUDIO_SAMPLE_SIZE);
+    audio_jitter_buffer_.Write(audioFrame->streamBuffer, numFrames);
 
     return cxrTrue;
   }
@@ -171,24 +333,30 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
   oboe::DataCallbackResult onAudioReady(oboe::AudioStream *oboeStream,
           void *audioData, int32_t numFrames)
   {
+    TRACE_SCOPE("onAudioReady");
+    if (oboeStream->getDirection() == oboe::Direction::Output) {
+      audio_jitter_buffer_.Read(static_cast<int16_t*>(audioData), numFrames);
+      return exiting_ ? oboe::DataCallbackResult::Stop : oboe::DataCallbackResult::Continue;
+    }
+
     if (!recording_stream_ || exiting_) {
       return oboe::DataCallbackResult::Stop;
     }
-    cxrAudioFrame recordedFrame{};
-    recordedFrame.streamBuffer = (int16_t*)audioData;
-    recordedFrame.streamSizeBytes = numFrames * CXR_AUDIO_CHANNEL_COUNT * CXR_AUDIO_SAMPLE_SIZE;
-    cxrSendAudio(cloudxr_receiver_, &recordedFrame);
+    // batched into fixed packets, and silence dropped, before it goes to the server.
+    mic_uplink_.Push(static_cast<const int16_t*>(audioData), numFrames);
 
     return oboe::DataCallbackResult::Continue;
   }
 
+  // GL thread only, the connection worker uses the copy in connect_device_desc_.
   cxrDeviceDesc GetDeviceDesc() {
     device_desc_.numVideoStreamDescs = 1;
     device_desc_.videoStreamDescs[0].format = cxrClientSurfaceFormat_RGBA;
     device_desc_.videoStreamDescs[0].width = stream_width_;
     device_desc_.videoStreamDescs[0].height = stream_height_;
     device_desc_.videoStreamDescs[0].fps = static_cast<float>(fps_);
-    device_desc_.videoStreamDescs[0].maxBitrate = launch_options_.mMaxVideoBitrate;
+    device_desc_.videoStreamDescs[0].maxBitrate = launch_options_.adaptive_res_ ?
+        resolution_controller_.GetMaxBitrateKbps() : launch_options_.mMaxVideoBitrate;
     device_desc_.stereoDisplay = false;
     device_desc_.maxResFactor = 1.0f; // leave alone, don't extra oversample on server.
     device_desc_.ipd = 0.00f;
@@ -203,10 +371,41 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
     return device_desc_;
   }
 
+  // Kicks off receiver creation and connection on the connection worker.
+  // Must be called on the GL thread, as the receiver shares its EGL context.
+  // @return false if already connecting or connected.
+  bool StartConnect() {
+    egl_display_ = eglGetCurrentDisplay();
+    egl_context_ = eglGetCurrentContext();
+    if (launch_options_.latency_trace_) {
+      latency_tracker_.OpenTrace(outputPath_ + "latency_trace.bin");
+    }
+    light_filter_.Reset();
+    if (launch_options_.adaptive_res_ && !resolution_controller_.IsInitialized()) {
+      resolution_controller_.Reset(launch_options_.res_factor_, static_cast<float>(fps_),
+                                   launch_options_.mMaxVideoBitrate);
+    }
+    return connection_.Start();
+  }
+
+  ConnectionWorker::State GetConnectionState() const {
+    return connection_.GetState();
+  }
+
+  cxrError GetConnectionError() const {
+    return connection_.GetLastError();
+  }
+
+  // Called on the GL thread when the server drops us, reconnects in the background.
+  void OnConnectionLost() {
+    connection_.OnConnectionLost();
+  }
+
   // Note we have to delay this function until after we have
   // a working ar session and have grabbed proj matrix...
   // TODO: this may be sufficient to push for CreateReceiver to take
   // receiverdesc w/o devicedesc, and Connect to take devicedesc directly.
+  // Runs on the connection worker thread, see StartConnect().
   cxrError Init() {
     if (cloudxr_receiver_)
       return cxrError_Success; // already have receiver initialized, no error? TODO
@@ -214,10 +413,10 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
     CXR_LOGI("Initializing CloudXR Receiver...");
 
     cxrGraphicsContext context{cxrGraphicsContext_GLES};
-    context.egl.display = eglGetCurrentDisplay();
-    context.egl.context = eglGetCurrentContext();
+    context.egl.display = egl_display_;
+    context.egl.context = egl_context_;
 
-    auto device_desc = GetDeviceDesc();
+    auto device_desc = connect_device_desc_;
 
     cxrClientCallbacks clientProxy = { 0 };
     clientProxy.GetTrackingState = [](void* context, cxrVRTrackingState* trackingState)
@@ -238,6 +437,10 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
         // note that at the moment, we don't need/use the client context.
         dispatchLogMsg(level, category, extra, tag, messageText);
     };
+    clientProxy.UpdateClientState = [](void* context, cxrClientState state, cxrError error)
+    {
+        return reinterpret_cast<CloudXRClient*>(context)->UpdateClientState(state, error);
+    };
 
       // context is now IN the callback struct.
     clientProxy.clientContext = this;
@@ -255,6 +458,8 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
       playback_stream_builder.setFormat(oboe::AudioFormat::I16);
       playback_stream_builder.setChannelCount(oboe::ChannelCount::Stereo);
       playback_stream_builder.setSampleRate(CXR_AUDIO_SAMPLING_RATE);
+      playback_stream_builder.setDataCallback(this);
+      audio_jitter_buffer_.Reset(CXR_AUDIO_SAMPLING_RATE);
 
       oboe::Result r = playback_stream_builder.openStream(playback_stream_);
       if (r != oboe::Result::OK) {
@@ -305,6 +510,7 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
       recording_stream_builder.setSampleRate(CXR_AUDIO_SAMPLING_RATE);
       recording_stream_builder.setInputPreset(oboe::InputPreset::VoiceCommunication);
       recording_stream_builder.setDataCallback(this);
+      mic_uplink_.Reset(CXR_AUDIO_SAMPLING_RATE, kMicPacketMs, launch_options_.mic_vad_);
 
       oboe::Result r = recording_stream_builder.openStream(recording_stream_);
       if (r != oboe::Result::OK) {
@@ -356,6 +562,7 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
     return cxrError_Success;
 }
 
+  // Runs on the connection worker thread, after Init().
   cxrError Connect() {
     if (!IsCreated())
       return cxrError_Client_Setup_Failed;
@@ -365,7 +572,8 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
 
     CXR_LOGI("Connecting to CloudXR at %s...", launch_options_.mServerIP.c_str());
 
-    connectionDesc.async = cxrFalse;
+    // returns right away, UpdateClientState() reports how it went.
+    connectionDesc.async = cxrTrue;
     connectionDesc.useL4S = launch_options_.mUseL4S;
     connectionDesc.clientNetwork = launch_options_.mClientNetwork;
     connectionDesc.topology = launch_options_.mTopology;
@@ -375,9 +583,6 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
       CXR_LOGE("Failed to connect to CloudXR server at %s. Error %d, %s.", launch_options_.mServerIP.c_str(), (int)err, cxrErrorString(err));
       return err;
     }
-    // else, good to go.
-    CXR_LOGI("Receiver connected to server!");
-    isStreaming_ = true;
 
     // AR shouldn't have an arena, should it?  Maybe something large?
     //CXR_LOGI("Setting default 1m radius arena boundary.", result);
@@ -387,6 +592,32 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
   }
 
   void Teardown() {
+    // cuts short any connection attempt, then calls DestroyReceiver().
+    connection_.Stop();
+
+    // keep the session's stats, and start afresh on resume.
+    stats_collector_.AppendCsv(outputPath_ + "connection_stats.csv");
+    stats_collector_.Reset();
+  }
+
+  // See StatsCollector::GetPercentiles().  Safe to call from any thread.
+  int GetConnectionStats(float out[StatsCollector::kNumMetrics * StatsCollector::kNumPercentiles]) const {
+    return stats_collector_.GetPercentiles(out);
+  }
+
+  // this is whether we created the CloudXR Receiver
+  bool IsCreated() const {
+    return (nullptr != cloudxr_receiver_);
+  }
+
+  // this is if we're connected to a server and streaming
+  bool IsStreaming() const {
+    return connection_.GetState() == ConnectionWorker::State::kStreaming;
+  }
+
+  // Closes audio and destroys the receiver.  Called by the connection worker
+  // before reconnecting, and from Teardown() once the worker has stopped.
+  void DestroyReceiver() {
     if (playback_stream_)
     {
         playback_stream_->close();
@@ -401,26 +632,16 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
 
     if (cloudxr_receiver_) {
       CXR_LOGI("Tearing down CloudXR...");
+      Release();
       cxrDestroyReceiver(cloudxr_receiver_);
       cloudxr_receiver_ = nullptr;
-      isStreaming_ = false;
     }
   }
 
-  // this is whether we created the CloudXR Receiver
-  bool IsCreated() const {
-    return (nullptr != cloudxr_receiver_);
-  }
-
-  // this is if we're connected to a server and streaming
-  bool IsStreaming() const {
-    return isStreaming_;
-  }
-
-  void SetPoseMatrix(const glm::mat4& pose_mat) {
-    std::lock_guard<std::mutex> lock(state_mutex_);
-
-    auto& pose_matrix = pose_matrix_[current_idx_];
+  // camera_frame is the BackgroundRenderer frame count of the camera image this
+  // pose was sampled with, so the image can be found again in DetermineOffset().
+  void SetPoseMatrix(const glm::mat4& pose_mat, uint64_t camera_frame) {
+    cxrMatrix34 pose_matrix;
 
       pose_matrix.m[0][0] = pose_mat[0][0];
       pose_matrix.m[0][1] = pose_mat[1][0];
@@ -435,10 +656,22 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
       pose_matrix.m[2][2] = pose_mat[2][2];
       pose_matrix.m[2][3] = pose_mat[3][2];
 
-    current_idx_ = (current_idx_ + 1)%kQueueLen;
+    const uint64_t pose_id = pose_history_.Push(pose_matrix, camera_frame);
+    latency_tracker_.OnPoseSent(pose_id, util::NowUs());
+  }
+
+  // Latency tracking of the stages not already inside this class, called
+  // right after ArSession_update and on every return from OnDrawFrame.
+  void OnArUpdate() {
+    latency_tracker_.OnArUpdate(util::NowUs());
+  }
+
+  void OnFrameEnd() {
+    latency_tracker_.OnFrameSwapped(util::NowUs());
   }
 
   void SetProjectionMatrix(const glm::mat4& projection) {
+    projection_ = projection;
     if (fabsf(projection[2][0]) > 0.0001f) {
       // Non-symmetric projection
       const float oneOver00 = 1.f/projection[0][0];
@@ -472,55 +705,111 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
         device_desc_.proj[0][2], device_desc_.proj[0][3]);
   }
 
+  const glm::mat4& GetProjectionMatrix() const {
+    return projection_;
+  }
+
   void SetFps(int fps) {
     fps_ = fps;
   }
 
-  int DetermineOffset() const {
-    for (int offset = 0; offset < kQueueLen; offset++) {
-      const int idx = current_idx_ < offset ?
-          kQueueLen + (current_idx_ - offset)%kQueueLen :
-          (current_idx_ - offset)%kQueueLen;
-
-      const auto& pose_matrix = pose_matrix_[idx];
+  // Number of camera frames the look-back queue must hold to find the camera
+  // image matching a streamed frame: one network round trip plus one stream
+  // frame interval, measured in camera frames, plus some slack for decode and
+  // latch.  Uses a guess until the first connection stats arrive.
+  int GetCameraQueueLength() const {
+    if (launch_options_.history_frames_ > 0)
+      return launch_options_.history_frames_;
+
+    const int kMarginFrames = 3;
+    const float kDefaultRoundTripMs = 50.0f;
+
+    const float rtt_ms = stats_.roundTripDelayMs > 0 ?
+        (float)stats_.roundTripDelayMs : kDefaultRoundTripMs;
+    const float stream_fps = stats_.framesPerSecond > 0.0f ?
+        stats_.framesPerSecond : (float)fps_;
+    const float latency_ms = rtt_ms + 1000.0f / stream_fps;
+    return (int)ceilf(latency_ms * fps_ / 1000.0f) + kMarginFrames;
+  }
 
-      int notMatch = 0;
-      for (int i=0; i<3; i++) {
-          for (int j=0; j<4; j++) {
-              if (fabsf(pose_matrix.m[i][j] - framesLatched_.poseMatrix.m[i][j]) >= 0.0001f)
-                  notMatch++;
-          }
-      }
-      if (0==notMatch) // then matrices are close enough to qualify as equal
-          return offset;
+  // Returns how many camera frames back from camera_frame (the current
+  // BackgroundRenderer frame count) the last latched server frame's pose was
+  // taken.
+  int DetermineOffset(uint64_t camera_frame) const {
+    uint64_t pose_camera_frame = 0;
+    if (!pose_history_.FindCameraFrame(frame_pose_id_, &pose_camera_frame) ||
+        pose_camera_frame > camera_frame) {
+      return 0;
     }
 
-    return 0;
+    return (int)std::min<uint64_t>(camera_frame - pose_camera_frame, kQueueLen - 1);
   }
 
+  // The latched frame is held across display frames until the pacer expects
+  // a new one, then released and replaced.  So a Success return may be the
+  // same frame as last time, drawn again.
   cxrError Latch() {
-    if (latched_) {
-      return cxrError_Success;
-    }
-
+    TRACE_SCOPE("Latch");
     if (!IsStreaming()) {
       return cxrError_Not_Connected;
     }
 
-    // Fetch the frame
-    const uint32_t timeout_ms = 150;
+    const int64_t now_us = util::NowUs();
+    if (latched_) {
+      if (!frame_pacer_.IsFrameDue(now_us)) {
+        frame_pacer_.OnFrameHeld();
+        return cxrError_Success;
+      }
+      Release();
+    }
+
+    // Fetch the frame, waiting only a few ms on one that is due, so a late
+    // server never holds back the camera.
+    const uint32_t timeout_ms = frame_pacer_.GetLatchTimeoutMs(now_us);
     cxrError status = cxrLatchFrame(cloudxr_receiver_, &framesLatched_,
             cxrFrameMask_All, timeout_ms);
 
     if (status != cxrError_Success) {
-      CXR_LOGI("CloudXR frame is not available!");
+      if (status == cxrError_Frame_Not_Ready) {
+        frame_pacer_.OnFrameMissed();
+      } else {
+        CXR_LOGI("CloudXR frame is not available!");
+      }
       return status;
     }
 
+    frame_pacer_.OnFrameLatched(util::NowUs());
     latched_ = true;
+    fresh_frame_ = true;
+    frame_pose_id_ = framesLatched_.poseID;
+    frame_pose_ = framesLatched_.poseMatrix;
+    latency_tracker_.OnFrameLatched(frame_pose_id_, util::NowUs());
     return cxrError_Success;
   }
 
+  // @return true once for each newly latched frame, as opposed to a held one.
+  bool TakeFreshFrame() {
+    const bool fresh = fresh_frame_;
+    fresh_frame_ = false;
+    return fresh;
+  }
+
+  // The pose the last latched frame was rendered from, as echoed back by
+  // the server.
+  bool GetFramePose(glm::mat4* pose_mat) const {
+    if (frame_pose_id_ == PoseHistory::kInvalidPoseId) {
+      return false;
+    }
+
+    *pose_mat = glm::mat4(1.0f);
+    for (int row = 0; row < 3; row++) {
+      for (int col = 0; col < 4; col++) {
+        (*pose_mat)[col][row] = frame_pose_.m[row][col];
+      }
+    }
+    return true;
+  }
+
   void Release() {
     if (!latched_) {
       return;
@@ -531,19 +820,39 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
   }
 
   void Render(const float color_correction[4]) {
+    TRACE_SCOPE("Render");
     if (!IsStreaming() || !latched_) {
       return; // we have nothing to blit...
     }
 
     cxrBlitFrame(cloudxr_receiver_, &framesLatched_, cxrFrameMask_Mono_With_Alpha);
+    // CPU side only, the GPU time of the blit is in the GpuTimer report.
+    latency_tracker_.OnFrameBlitted(frame_pose_id_, util::NowUs());
   }
 
-  void Stats() {
+  // @return true if new connection stats were fetched.
+  bool Stats() {
+    // Sample connection stats into the time series twice a second
+    const int64_t STATS_SAMPLE_INTERVAL_US = 500000;
+    const int64_t now_us = util::NowUs();
+    if (now_us - last_stats_sample_us_ >= STATS_SAMPLE_INTERVAL_US &&
+        cxrGetConnectionStats(cloudxr_receiver_, &stats_) == cxrError_Success)
+    {
+      last_stats_sample_us_ = now_us;
+      stats_collector_.AddSample(stats_);
+      if (launch_options_.adaptive_res_ && resolution_controller_.Update(stats_)) {
+        // The new size and bitrate go out in the device desc of the reconnect.
+        ApplyResFactor(resolution_controller_.GetFactor());
+        Release();
+        connection_.Renegotiate();
+        return false;
+      }
+    }
+
     // Log connection stats every 3 seconds
     const int STATS_INTERVAL_SEC = 3;
     frames_until_stats_--;
-    if (frames_until_stats_ <= 0 &&
-        cxrGetConnectionStats(cloudxr_receiver_, &stats_) == cxrError_Success)
+    if (frames_until_stats_ <= 0 && last_stats_sample_us_ != 0)
     {
       // Capture the key connection statistics
       char statsString[64] = { 0 };
@@ -589,12 +898,28 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
       }
 
       CXR_LOGI("%s    %s    %s", statsString, qualityString, reasonString);
+      stats_collector_.LogReport();
+      frame_pacer_.LogReport();
+      latency_tracker_.LogReport();
+      if (playback_stream_) {
+        audio_jitter_buffer_.LogReport();
+      }
+      if (recording_stream_) {
+        mic_uplink_.LogReport();
+      }
+      if (launch_options_.using_env_lighting_) {
+        light_filter_.LogReport();
+      }
       frames_until_stats_ = (int)stats_.framesPerSecond * STATS_INTERVAL_SEC;
+      return true;
     }
+    return false;
   }
 
   void UpdateLightProps(const float primaryDirection[3], const float primaryIntensity[3],
       const float ambient_spherical_harmonics[27]) {
+    if (!IsStreaming()) return;
+
     cxrLightProperties lightProperties;
 
     for (uint32_t n = 0; n < 3; n++) {
@@ -606,7 +931,10 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
       lightProperties.ambientLightSh[n/3].v[n%3] = ambient_spherical_harmonics[n];
     }
 
-    cxrSendLightProperties(cloudxr_receiver_, &lightProperties);
+    // smoothed, and only sent once it has visibly changed.
+    if (light_filter_.Update(lightProperties, util::NowUs())) {
+      cxrSendLightProperties(cloudxr_receiver_, &light_filter_.GetSmoothed());
+    }
   }
 
   bool HandleLaunchOptions(std::string &cmdline) {
@@ -642,6 +970,10 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
     std::string filePrefix = "CloudXR AR Sample";
     g_logFile.init(appOutputPath_, filePrefix);
 
+    if (launch_options_.trace_) {
+      trace::Start(appOutputPath_ + "trace.json");
+    }
+
     return true;
   }
 
@@ -667,11 +999,11 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
       std::swap(w, h);
     }
 
-    // apply the res factor to width and height, and make sure they are even for stream res.
-    stream_width_ = ((uint32_t)round((float)w * launch_options_.res_factor_)) & ~1;
-    stream_height_ = ((uint32_t)round((float)h * launch_options_.res_factor_)) & ~1;
+    display_width_ = w;
+    display_height_ = h;
     CXR_LOGI("SetStreamRes: Display res passed = %dx%d", w, h);
-    CXR_LOGI("SetStreamRes: Stream res set = %dx%d [factor %0.2f]", stream_width_, stream_height_, launch_options_.res_factor_);
+    ApplyResFactor(resolution_controller_.IsInitialized() ?
+                   resolution_controller_.GetFactor() : launch_options_.res_factor_);
   }
 
   // Send a touch event along to the server/host application
@@ -692,31 +1024,67 @@ class HelloArApplication::CloudXRClient : public oboe::AudioStreamDataCallback {
 
 private:
   static constexpr int kQueueLen = BackgroundRenderer::kQueueLen;
+  // length of the microphone packets sent to the server.
+  static constexpr int32_t kMicPacketMs = 10;
+
+  // apply the res factor to width and height, and make sure they are even for stream res.
+  void ApplyResFactor(float factor) {
+    stream_width_ = ((uint32_t)round((float)display_width_ * factor)) & ~1;
+    stream_height_ = ((uint32_t)round((float)display_height_ * factor)) & ~1;
+    CXR_LOGI("SetStreamRes: Stream res set = %dx%d [factor %0.2f]", stream_width_, stream_height_, factor);
+  }
 
   std::string outputPath_ = {};
   cxrReceiverHandle cloudxr_receiver_ = nullptr;
-  bool isStreaming_ = false;
+
+  // captured on the GL thread in StartConnect(), used by Init() on the worker.
+  EGLDisplay egl_display_ = EGL_NO_DISPLAY;
+  EGLContext egl_context_ = EGL_NO_CONTEXT;
+  // captured on the GL thread whenever the worker (re)connects.
+  cxrDeviceDesc connect_device_desc_ = {};
 
   ARLaunchOptions launch_options_;
 
+  uint32_t display_width_ = 960;
+  uint32_t display_height_ = 1920;
   uint32_t stream_width_ = 720;
   uint32_t stream_height_ = 1440;
+  ResolutionController resolution_controller_;
 
   cxrFramesLatched framesLatched_ = {};
   bool latched_ = false;
-
-  std::mutex state_mutex_;
-  cxrMatrix34 pose_matrix_[kQueueLen] = {};
+  bool fresh_frame_ = false;
+  // survives Release(), so a cached copy of the frame can still be matched.
+  uint64_t frame_pose_id_ = PoseHistory::kInvalidPoseId;
+  cxrMatrix34 frame_pose_ = {};
+  FramePacer frame_pacer_;
+  glm::mat4 projection_ = glm::mat4(1.0f);
+
+  static_assert(PoseHistory::kCapacity >= kQueueLen,
+                "Pose history must cover the whole camera look-back queue");
+
+  // written on the GL thread, read on the CloudXR callback thread.
+  PoseHistory pose_history_;
+  LatencyTracker latency_tracker_;
   cxrDeviceDesc device_desc_ = {};
-  int current_idx_ = 0;
 
   int fps_ = 60;
 
   std::shared_ptr<oboe::AudioStream> recording_stream_{};
   std::shared_ptr<oboe::AudioStream> playback_stream_{};
+  // filled by RenderAudio() on the CloudXR thread, drained by the playback callback.
+  AudioJitterBuffer audio_jitter_buffer_;
+  MicUplink mic_uplink_;
+
+  LightFilter light_filter_;
 
   cxrConnectionStats stats_ = {};
   int frames_until_stats_ = 60;
+  int64_t last_stats_sample_us_ = 0;
+  StatsCollector stats_collector_;
+
+  // last, so it is destroyed, and its worker joined, before anything it uses.
+  ConnectionWorker connection_;
 };
 // ===== END OF CloudXRClient =====
 
@@ -744,11 +1112,15 @@ HelloArApplication::~HelloArApplication() {
         ArFrame_destroy(ar_frame_);
         ar_frame_ = nullptr;
     }
+    ar_objects_ = nullptr;
     ArSession_destroy(ar_session_);
     ar_session_ = nullptr;
   }
 
   cloudxr_client_ = nullptr; // this is smart ptr, null will destroy
+
+  // after the client, so its threads have recorded their last scopes.
+  trace::Stop();
 }
 
 // other initialization of app/cxr client, which could fail.
@@ -772,6 +1144,13 @@ std::string HelloArApplication::GetServerIp() {
   return cloudxr_client_->GetServerAddr();
 }
 
+int HelloArApplication::GetConnectionStats(float out[kConnectionStatsCount]) const {
+  static_assert(kConnectionStatsCount ==
+                StatsCollector::kNumMetrics * StatsCollector::kNumPercentiles,
+                "Connection stats layout out of sync with StatsCollector");
+  return cloudxr_client_->GetConnectionStats(out);
+}
+
 void HelloArApplication::NotifyUserError(ArStatus stat, const char* filename, const int linenum, bool terminate /*==false*/) {
     CXR_LOGE("Error #%d from ARCore at %s:%d", stat, filename, linenum);
     // TODO: should really push back to Java and display a dialog before exiting, and exit cleanly.
@@ -826,6 +1205,8 @@ void HelloArApplication::OnResume(void* env, void* context, void* activity) {
     ArFrame_create(ar_session_, &ar_frame_);
     CHECK(ar_frame_);
 
+    ar_objects_ = std::make_unique<util::ArObjectPool>(ar_session_);
+
     ArSession_setDisplayGeometry(ar_session_, display_rotation_, display_width_, display_height_);
 
     // Retrieve supported camera configs.
@@ -925,6 +1306,11 @@ void HelloArApplication::OnSurfaceCreated() {
 
   background_renderer_.InitializeGlContent(asset_manager_, cam_image_width_, cam_image_height_);
   plane_renderer_.InitializeGlContent(asset_manager_);
+  stream_frame_cache_.InitializeGlContent(asset_manager_, display_width_, display_height_);
+
+  gpu_timer_.InitializeGlContent();
+  gpu_stage_camera_copy_ = gpu_timer_.AddStage("camera copy");
+  gpu_stage_stream_blit_ = gpu_timer_.AddStage("stream blit");
 }
 
 void HelloArApplication::OnDisplayGeometryChanged(int display_rotation,
@@ -934,19 +1320,98 @@ void HelloArApplication::OnDisplayGeometryChanged(int display_rotation,
   display_rotation_ = display_rotation;
   display_width_ = width;
   display_height_ = height;
+  stream_frame_cache_.SetSize(width, height);
   if (ar_session_ != nullptr) {
     ArSession_setDisplayGeometry(ar_session_, display_rotation, width, height);
   }
   cloudxr_client_->SetStreamRes(display_width_, display_height_, display_rotation);
 }
 
+void HelloArApplication::UpdateCameraQueueLength() {
+  const int needed = cloudxr_client_->GetCameraQueueLength();
+  const int current = background_renderer_.GetQueueLength();
+
+  // Grow right away so we can reach back far enough, shrink lazily.
+  if (needed > current || needed + kCameraQueueShrinkSlack < current) {
+    background_renderer_.SetQueueLength(needed);
+  }
+}
+
+bool HelloArApplication::IsStreamReprojected(bool latched) const {
+  if (!cached_frame_pose_valid_) {
+    return false;
+  }
+
+  const ARLaunchOptions& options = cloudxr_client_->GetLaunchOptions();
+  return options.late_reprojection_ ||
+      (!latched && options.hold_mode_ == StreamFrameCache::HoldMode::kReproject);
+}
+
+void HelloArApplication::DrawStream(bool latched,
+                                    const float color_correction[4],
+                                    const glm::mat4& current_pose) {
+  TRACE_SCOPE("DrawStream");
+  glViewport(0, 0, display_width_, display_height_);
+
+  const ARLaunchOptions& options = cloudxr_client_->GetLaunchOptions();
+  const bool fresh = latched && cloudxr_client_->TakeFreshFrame();
+
+  // Late reprojection redraws every frame from the cache, the hold modes only
+  // need a copy while frames have recently come late.
+  const bool hold_armed = options.hold_mode_ != StreamFrameCache::HoldMode::kOff &&
+      last_missed_frame_us_ != 0 &&
+      util::NowUs() - last_missed_frame_us_ < kHoldFrameArmUs;
+  if (fresh) {
+    if (options.late_reprojection_ || hold_armed) {
+      // Each new frame is blitted into the cache once.
+      stream_frame_cache_.BeginCapture();
+      cloudxr_client_->Render(color_correction);
+      stream_frame_cache_.EndCapture();
+      cached_frame_pose_valid_ = cloudxr_client_->GetFramePose(&cached_frame_pose_);
+      glViewport(0, 0, display_width_, display_height_);
+    } else {
+      // don't bring back an older frame than the one on screen.
+      stream_frame_cache_.Invalidate();
+    }
+  }
+
+  // A latched frame goes straight to the screen, the cache is only drawn for
+  // a frame that came late.
+  if (latched && !options.late_reprojection_) {
+    cloudxr_client_->Render(color_correction);
+    return;
+  }
+
+  glm::mat3 reprojection(1.0f);
+  if (IsStreamReprojected(latched)) {
+    reprojection = StreamFrameCache::RotationalReprojection(
+        cloudxr_client_->GetProjectionMatrix(), cached_frame_pose_, current_pose);
+  }
+  stream_frame_cache_.Draw(reprojection);
+}
+
+void HelloArApplication::CountFrameAllocations() {
+  const uint64_t count = util::GetThreadAllocationCount();
+  if (count == 0) {
+    return;  // not built with HELLO_AR_COUNT_ALLOCATIONS
+  }
+
+  // Between two frame starts, so this covers everything the GL thread does.
+  frame_allocations_ += count - last_allocation_count_;
+  last_allocation_count_ = count;
+  if (++allocation_frames_ == kAllocationReportFrames) {
+    CXR_LOGI("GL thread allocations: %.2f per frame over %d frames",
+             (float)frame_allocations_ / allocation_frames_, allocation_frames_);
+    frame_allocations_ = 0;
+    allocation_frames_ = 0;
+  }
+}
+
 void HelloArApplication::UpdateImageAnchors() {
   if (!using_image_anchors_)
     return;
 
-  ArTrackableList* updated_image_list = nullptr;
-  ArTrackableList_create(ar_session_, &updated_image_list);
-  CHECK(updated_image_list != nullptr);
+  ArTrackableList* updated_image_list = ar_objects_->image_list.GetArTrackableList();
   ArFrame_getUpdatedTrackables(
       ar_session_, ar_frame_, AR_TRACKABLE_AUGMENTED_IMAGE, updated_image_list);
 
@@ -1005,9 +1470,6 @@ void HelloArApplication::UpdateImageAnchors() {
     }  // End of switch (tracking_state)
   }    // End of for (int i = 0; i < image_list_size; ++i) {
 
-  ArTrackableList_destroy(updated_image_list);
-  updated_image_list = nullptr;
-
   if (!base_frame_calibrated_ && !augmented_image_map.empty()) {
     anchor_ = augmented_image_map.begin()->second.second;
     base_frame_calibrated_ = true;
@@ -1017,6 +1479,16 @@ void HelloArApplication::UpdateImageAnchors() {
 // Render the scene.
 // return value 0 means that Java should finish and clean up.
 int HelloArApplication::OnDrawFrame() {
+  TRACE_SCOPE("OnDrawFrame");
+  CountFrameAllocations();
+
+  // Ends the frame for latency tracking on every return below, including the
+  // early one while streaming.
+  struct FrameEnd {
+    CloudXRClient* client;
+    ~FrameEnd() { client->OnFrameEnd(); }
+  } frame_end{cloudxr_client_.get()};
+
   // clearing to dark red to start, so it is obvious if we fail out early or don't render anything
   // but if exiting, just render black on the way out...
   glClearColor(exiting_? 0.0f : 0.3f, 0.0f, 0.0f, 1.0f);
@@ -1041,6 +1513,7 @@ int HelloArApplication::OnDrawFrame() {
   if (ArSession_update(ar_session_, ar_frame_) != AR_SUCCESS) {
     CXR_LOGE("HelloArApplication::OnDrawFrame ArSession_update error");
   }
+  cloudxr_client_->OnArUpdate();
 
   ArCamera* ar_camera;
   ArFrame_acquireCamera(ar_session_, ar_frame_, &ar_camera);
@@ -1059,14 +1532,32 @@ int HelloArApplication::OnDrawFrame() {
   ArCamera_getTrackingState(ar_session_, ar_camera, &camera_tracking_state);
   ArCamera_release(ar_camera);
 
-  // Draw to camera queue
-  background_renderer_.Draw(ar_session_, ar_frame_);
+  gpu_timer_.Update();
+
+  // The camera queue is only needed to match streamed frames to camera images,
+  // so start filling it once calibrated, which is just ahead of connecting.
+  // Late reprojection moves streamed frames to the live image instead.
+  const bool use_camera_queue = base_frame_calibrated_ &&
+      !cloudxr_client_->GetLaunchOptions().late_reprojection_;
+  if (use_camera_queue) {
+    if (cloudxr_client_->GetConnectionState() == ConnectionWorker::State::kIdle) {
+      // size the queue before its first use, so it is only allocated once.
+      const ARLaunchOptions& options = cloudxr_client_->GetLaunchOptions();
+      background_renderer_.SetHistoryStorage(options.history_format_, options.history_scale_);
+      background_renderer_.SetQueueLength(cloudxr_client_->GetCameraQueueLength());
+    }
+
+    // Draw to camera queue
+    gpu_timer_.Begin(gpu_stage_camera_copy_);
+    background_renderer_.Draw(ar_session_, ar_frame_);
+    gpu_timer_.End(gpu_stage_camera_copy_);
+  }
 
   glViewport(0, 0, display_width_, display_height_);
 
-  if (!cloudxr_client_->IsStreaming() || !base_frame_calibrated_) {
-    // Draw camera image to the screen
-    background_renderer_.Draw(ar_session_, ar_frame_, 0);
+  if (!cloudxr_client_->IsStreaming() || !use_camera_queue) {
+    // Draw camera image straight to the screen
+    background_renderer_.DrawCamera(ar_session_, ar_frame_);
   }
 
   // If the camera isn't tracking don't bother rendering other objects.
@@ -1125,55 +1616,74 @@ int HelloArApplication::OnDrawFrame() {
         glm::mat4 anchor_pose_mat(1.0f);
 
         util::GetTransformMatrixFromAnchor(*anchor_, ar_session_,
+                                           ar_objects_->pose.GetArPose(),
                                            &anchor_pose_mat);
 
         base_frame_ = glm::inverse(anchor_pose_mat);
       }
     }
 
-    if (!cloudxr_client_->IsStreaming()) {
-      cxrError status = cxrError_Success;
-      if (!cloudxr_client_->IsCreated()) {
-        // now we can set projection matrix, and initialize the cxr_client (which really does cxrCreateReceiver)
-        cloudxr_client_->SetProjectionMatrix(projection_mat);
-        status = cloudxr_client_->Init();
-      }
-
-      if (status == cxrError_Success) {
-        status = cloudxr_client_->Connect();
-      }
-      // for sync connection, this will do for now to error check..
-      if (status != cxrError_Success) {
+    if (cloudxr_client_->GetConnectionState() == ConnectionWorker::State::kIdle) {
+      // a failed connection attempt leaves its error behind, give up on that.
+      const cxrError connect_error = cloudxr_client_->GetConnectionError();
+      if (connect_error != cxrError_Success) {
         exiting_ = true;
-        return ((int) status);
+        return ((int) connect_error);
       }
+
+      // now we can set projection matrix, and start the cxr_client creating its
+      // receiver and connecting in the background.  we keep drawing the camera
+      // and pushing poses meanwhile.
+      cloudxr_client_->SetProjectionMatrix(projection_mat);
+      cloudxr_client_->StartConnect();
     }
 
+    // Latch() reports cxrError_Not_Connected until the worker is done.
     const cxrError status = cloudxr_client_->Latch();
-    if (status != cxrError_Success) {
-      CXR_LOGE("Latch failed, %s", cxrErrorString(status));
+    if (status != cxrError_Success && cloudxr_client_->IsStreaming()) {
       if (status == cxrError_Not_Connected) {
-        exiting_ = true;
-        return status;
+        // server went away, keep the camera going while we reconnect.
+        CXR_LOGE("Latch failed, %s", cxrErrorString(status));
+        cloudxr_client_->OnConnectionLost();
       }
       else if (status == cxrError_Frame_Not_Ready) {
-        // TODO: if fixed framerate, should cache and re-render prior frame.
-        //  if not fixed, can just not swap backbuffer.
+        // a frame was due but came late, the frame pacer counts these rather
+        // than logging each one.  stream_frame_cache_ covers for it below,
+        // and keeps copies of the next frames in case more come late.
+        last_missed_frame_us_ = util::NowUs();
+      }
+      else {
+        CXR_LOGE("Latch failed, %s", cxrErrorString(status));
       }
       // else
       // TODO: code should handle other potential errors that are non-fatal, but
       //  may be enough to need to disconnect or reset view or other interruption cases.
     }
-    const bool have_frame = (status == cxrError_Success);
-    const int pose_offset = have_frame ? cloudxr_client_->DetermineOffset() : 0;
+    if (!cloudxr_client_->IsStreaming()) {
+      // don't bring back a frame from before a reconnect.
+      stream_frame_cache_.Invalidate();
+    }
 
-    // Render cached camera frame to the screen
-    glViewport(0, 0, display_width_, display_height_);
-    background_renderer_.Draw(ar_session_, ar_frame_, pose_offset);
+    // Without a new frame, fall back to the cached copy of the last one.
+    const StreamFrameCache::HoldMode hold_mode = cloudxr_client_->GetLaunchOptions().hold_mode_;
+    const bool latched = (status == cxrError_Success);
+    const bool have_frame = latched ||
+        (hold_mode != StreamFrameCache::HoldMode::kOff && stream_frame_cache_.IsValid());
+    // A reprojected frame matches the live camera image, otherwise find the
+    // image the frame was rendered against.
+    const int pose_offset = have_frame && !IsStreamReprojected(latched) ?
+        cloudxr_client_->DetermineOffset(background_renderer_.GetFrameCount()) : 0;
+
+    // Render cached camera frame to the screen, the live one is already
+    // there if we're still connecting.
+    if (cloudxr_client_->IsStreaming() && use_camera_queue) {
+      glViewport(0, 0, display_width_, display_height_);
+      background_renderer_.Draw(ar_session_, ar_frame_, pose_offset);
+    }
 
     // Setup pose matrix with our base frame
     const glm::mat4 cloudxr_pose_mat = base_frame_*glm::inverse(view_mat);
-    cloudxr_client_->SetPoseMatrix(cloudxr_pose_mat);
+    cloudxr_client_->SetPoseMatrix(cloudxr_pose_mat, background_renderer_.GetFrameCount());
 
     // Set light intensity to default. Intensity value ranges from 0.0f to 1.0f.
     // The first three components are color scaling factors.
@@ -1181,9 +1691,8 @@ int HelloArApplication::OnDrawFrame() {
     float color_correction[4] = {1.f, 1.f, 1.f, 0.466f};
     {
       // Get light estimation
-      ArLightEstimate* ar_light_estimate;
+      ArLightEstimate* ar_light_estimate = ar_objects_->light_estimate.GetArLightEstimate();
       ArLightEstimateState ar_light_estimate_state;
-      ArLightEstimate_create(ar_session_, &ar_light_estimate);
 
       ArFrame_getLightEstimate(ar_session_, ar_frame_, ar_light_estimate);
       ArLightEstimate_getState(ar_session_, ar_light_estimate,
@@ -1210,21 +1719,25 @@ int HelloArApplication::OnDrawFrame() {
                                              color_correction);
         }
       }
-
-      ArLightEstimate_destroy(ar_light_estimate);
     }
 
     if (have_frame) {
       // Composite CloudXR frame to the screen
-      glViewport(0, 0, display_width_, display_height_);
-      cloudxr_client_->Render(color_correction);
-      cloudxr_client_->Release();
-      cloudxr_client_->Stats();
+      gpu_timer_.Begin(gpu_stage_stream_blit_);
+      DrawStream(latched, color_correction, cloudxr_pose_mat);
+      gpu_timer_.End(gpu_stage_stream_blit_);
+      // the frame stays latched, Latch() releases it once a new one is due.
+      if (cloudxr_client_->Stats()) {
+        UpdateCameraQueueLength();
+        gpu_timer_.LogReport();
+      }
     }
   }
 
   // Calibrate base frame only when neccessary
   if (base_frame_calibrated_ || using_image_anchors_) {
+    // planes are only drawn while calibrating.
+    plane_renderer_.ReleaseUnusedMeshes();
     return(0);
   }
 
@@ -1238,6 +1751,7 @@ int HelloArApplication::OnDrawFrame() {
       glm::mat4 anchor_pose_mat(1.0f);
 
       util::GetTransformMatrixFromAnchor(*anchor_, ar_session_,
+                                         ar_objects_->pose.GetArPose(),
                                          &anchor_pose_mat);
 
       base_frame_ = glm::inverse(anchor_pose_mat);
@@ -1249,9 +1763,7 @@ int HelloArApplication::OnDrawFrame() {
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
   // Update and render planes.
-  ArTrackableList* plane_list = nullptr;
-  ArTrackableList_create(ar_session_, &plane_list);
-  CHECK(plane_list != nullptr);
+  ArTrackableList* plane_list = ar_objects_->plane_list.GetArTrackableList();
 
   ArTrackableType plane_tracked_type = AR_TRACKABLE_PLANE;
   ArSession_getAllTrackables(ar_session_, plane_tracked_type, plane_list);
@@ -1272,11 +1784,13 @@ int HelloArApplication::OnDrawFrame() {
     ArPlane_acquireSubsumedBy(ar_session_, ar_plane, &subsume_plane);
     if (subsume_plane != nullptr) {
       ArTrackable_release(ArAsTrackable(subsume_plane));
+      ArTrackable_release(ar_trackable);
       continue;
     }
 
     if (ArTrackingState::AR_TRACKING_STATE_TRACKING != out_tracking_state) {
       CXR_LOGE("Tracked plane lost, skipping drawing.");
+      ArTrackable_release(ar_trackable);
       continue;
     }
 
@@ -1284,14 +1798,13 @@ int HelloArApplication::OnDrawFrame() {
     ArTrackable_getTrackingState(ar_session_, ArAsTrackable(ar_plane),
                                  &plane_tracking_state);
     if (plane_tracking_state == AR_TRACKING_STATE_TRACKING) {
-      plane_renderer_.Draw(projection_mat, view_mat, *ar_session_, *ar_plane,
-                           kWhite);
+      plane_renderer_.AddPlane(*ar_session_, *ar_plane,
+                               ar_objects_->pose.GetArPose());
       ArTrackable_release(ar_trackable);
     }
   }
-
-  ArTrackableList_destroy(plane_list);
-  plane_list = nullptr;
+  plane_renderer_.Draw(projection_mat, view_mat, kWhite);
+  plane_renderer_.ReleaseUnusedMeshes();
 
   return(0);
 }
@@ -1312,13 +1825,12 @@ void HelloArApplication::OnTouched(float x, float y, bool longPress) {
     }
 
     base_frame_calibrated_ = false;
+    stream_frame_cache_.Invalidate();
     return;
   }
 
   if (ar_frame_ != nullptr && ar_session_ != nullptr) {
-    ArHitResultList* hit_result_list = nullptr;
-    ArHitResultList_create(ar_session_, &hit_result_list);
-    CHECK(hit_result_list);
+    ArHitResultList* hit_result_list = ar_objects_->hit_result_list.GetArHitResultList();
     ArFrame_hitTest(ar_session_, ar_frame_, x, y, hit_result_list);
 
     int32_t hit_result_list_size = 0;
@@ -1332,23 +1844,18 @@ void HelloArApplication::OnTouched(float x, float y, bool longPress) {
     ArHitResult* ar_hit_result = nullptr;
     ArTrackableType trackable_type = AR_TRACKABLE_NOT_VALID;
     for (int32_t i = 0; i < hit_result_list_size; ++i) {
-      ArHitResult* ar_hit = nullptr;
-      ArHitResult_create(ar_session_, &ar_hit);
+      // reused for every hit, the loop stops at the one it keeps.
+      ArHitResult* ar_hit = ar_objects_->hit_result.GetArHitResult();
       ArHitResultList_getItem(ar_session_, hit_result_list, i, ar_hit);
 
-      if (ar_hit == nullptr) {
-        CXR_LOGE("HelloArApplication::OnTouched ArHitResultList_getItem error");
-        return;
-      }
-
       ArTrackable* ar_trackable = nullptr;
       ArHitResult_acquireTrackable(ar_session_, ar_hit, &ar_trackable);
       ArTrackableType ar_trackable_type = AR_TRACKABLE_NOT_VALID;
       ArTrackable_getType(ar_session_, ar_trackable, &ar_trackable_type);
       // Creates an anchor if a plane or an oriented point was hit.
       if (AR_TRACKABLE_PLANE == ar_trackable_type) {
-        ArPose* hit_pose = nullptr;
-        ArPose_create(ar_session_, nullptr, &hit_pose);
+        util::ScopedArPose scoped_hit_pose(ar_session_);
+        ArPose* hit_pose = scoped_hit_pose.GetArPose();
         ArHitResult_getHitPose(ar_session_, ar_hit, hit_pose);
         int32_t in_polygon = 0;
         ArPlane* ar_plane = ArAsPlane(ar_trackable);
@@ -1356,8 +1863,8 @@ void HelloArApplication::OnTouched(float x, float y, bool longPress) {
 
         // Use hit pose and camera pose to check if hittest is from the
         // back of the plane, if it is, no need to create the anchor.
-        ArPose* camera_pose = nullptr;
-        ArPose_create(ar_session_, nullptr, &camera_pose);
+        util::ScopedArPose scoped_camera_pose(ar_session_);
+        ArPose* camera_pose = scoped_camera_pose.GetArPose();
         ArCamera* ar_camera;
         ArFrame_acquireCamera(ar_session_, ar_frame_, &ar_camera);
         ArCamera_getPose(ar_session_, ar_camera, camera_pose);
@@ -1365,9 +1872,6 @@ void HelloArApplication::OnTouched(float x, float y, bool longPress) {
         float normal_distance_to_plane = util::CalculateDistanceToPlane(
             *ar_session_, *hit_pose, *camera_pose);
 
-        ArPose_destroy(hit_pose);
-        ArPose_destroy(camera_pose);
-
         if (!in_polygon || normal_distance_to_plane < 0) {
           continue;
         }
@@ -1410,12 +1914,6 @@ void HelloArApplication::OnTouched(float x, float y, bool longPress) {
       }
 
       anchor_ = anchor;
-
-      ArHitResult_destroy(ar_hit_result);
-      ar_hit_result = nullptr;
-
-      ArHitResultList_destroy(hit_result_list);
-      hit_result_list = nullptr;
     }
   }
 }
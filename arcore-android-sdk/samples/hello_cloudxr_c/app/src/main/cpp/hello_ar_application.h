@@ -51,7 +51,9 @@
 #include "arcore_c_api.h"
 #include "background_renderer.h"
 #include "glm.h"
+#include "gpu_timer.h"
 #include "plane_renderer.h"
+#include "stream_frame_cache.h"
 #include "util.h"
 
 namespace hello_ar {
@@ -59,6 +61,9 @@ namespace hello_ar {
 // HelloArApplication handles all application logics.
 class HelloArApplication {
  public:
+  // Values returned by GetConnectionStats().
+  static constexpr int kConnectionStatsCount = 12;
+
   HelloArApplication(AAssetManager* asset_manager, std::string datapath);
   ~HelloArApplication();
 
@@ -102,10 +107,30 @@ class HelloArApplication {
     return plane_count_ > 0 || using_image_anchors_ || base_frame_calibrated_;
   }
 
+  // Fills out with rolling p50/p95/p99 of round trip (ms), bitrate (kbps),
+  // FPS and packet loss (%), in that order.  Safe to call from any thread.
+  // @return the number of samples they cover, 0 if there are none yet.
+  int GetConnectionStats(float out[kConnectionStatsCount]) const;
+
   static HelloArApplication* GetInstance() { return appinstance_; }
 
  private:
   void UpdateImageAnchors();
+  // Resizes the camera look-back queue to follow measured stream latency.
+  void UpdateCameraQueueLength();
+  // Logs heap allocations per frame, when built to count them.
+  void CountFrameAllocations();
+  // Returns true if the streamed frame is rotated to the live camera pose,
+  // rather than shown over the camera image it was rendered against.
+  // @param latched: a frame is latched, otherwise the cached one is redrawn.
+  bool IsStreamReprojected(bool latched) const;
+  // Composites the streamed frame.  A latched frame is blitted straight to the
+  // screen, stream_frame_cache_ is drawn when late reprojection is on or the
+  // frame came late.
+  // @param latched: a frame is latched, otherwise the cached one is redrawn.
+  // @param current_pose: pose of the live camera image.
+  void DrawStream(bool latched, const float color_correction[4],
+                  const glm::mat4& current_pose);
 
   static bool exiting_;
   static HelloArApplication* appinstance_;
@@ -117,6 +142,8 @@ class HelloArApplication {
   ArFrame* ar_frame_ = nullptr;
   ArCameraIntrinsics* ar_camera_intrinsics_ = nullptr;
   ArAnchor* anchor_ = nullptr;
+  // per-frame ARCore objects, created with the session.
+  std::unique_ptr<util::ArObjectPool> ar_objects_;
 
   bool install_requested_ = false;
   int display_width_ = 1;
@@ -138,8 +165,24 @@ class HelloArApplication {
   BackgroundRenderer background_renderer_;
   PlaneRenderer plane_renderer_;
 
+  // Last streamed frame, and the pose it was rendered from.
+  StreamFrameCache stream_frame_cache_;
+  glm::mat4 cached_frame_pose_;
+  bool cached_frame_pose_valid_ = false;
+  // When Latch() last found a due frame not ready, or 0.
+  int64_t last_missed_frame_us_ = 0;
+
+  GpuTimer gpu_timer_;
+  int gpu_stage_camera_copy_ = -1;
+  int gpu_stage_stream_blit_ = -1;
+
   int32_t plane_count_ = 0;
 
+  static constexpr int kAllocationReportFrames = 300;
+  uint64_t last_allocation_count_ = 0;
+  uint64_t frame_allocations_ = 0;
+  int allocation_frames_ = 0;
+
   // CloudXR client interface class
   class CloudXRClient;
   std::unique_ptr<CloudXRClient> cloudxr_client_;
@@ -133,6 +133,18 @@ JNI_METHOD(jstring, getServerIp)
   return env->NewStringUTF(ip.c_str());
 }
 
+JNI_METHOD(jfloatArray, getConnectionStats)
+(JNIEnv *env, jclass, jlong native_application) {
+  float stats[HelloArApplication::kConnectionStatsCount];
+  if (native(native_application)->GetConnectionStats(stats) == 0) {
+    return env->NewFloatArray(0);
+  }
+
+  jfloatArray result = env->NewFloatArray(HelloArApplication::kConnectionStatsCount);
+  env->SetFloatArrayRegion(result, 0, HelloArApplication::kConnectionStatsCount, stats);
+  return result;
+}
+
 JNI_METHOD(void, onResume)
 (JNIEnv *env, jclass, jlong native_application, jobject context,
  jobject activity) {
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "latency_tracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "CloudXRLog.h"
+
+namespace hello_ar {
+namespace {
+// Written at the start of the trace file, followed by the stage count and
+// record size as uint32_t, then the records.
+constexpr char kTraceMagic[8] = "CXRLAT1";
+
+// Histogram names, each the interval ending at that stage.  The first slot
+// holds the whole pipeline instead.
+constexpr const char* kIntervalNames[LatencyTracker::kNumStages] = {
+    "total", "pose", "pickup", "server", "blit", "swap",
+};
+}  // namespace
+
+LatencyTracker::~LatencyTracker() {
+  CloseTrace();
+}
+
+void LatencyTracker::OnArUpdate(int64_t now_us) {
+  ar_update_us_ = now_us;
+}
+
+void LatencyTracker::OnPoseSent(uint64_t pose_id, int64_t now_us) {
+  Entry& entry = entries_[pose_id % kCapacity];
+  entry.pose_id = pose_id;
+  std::fill(std::begin(entry.stage_us), std::end(entry.stage_us), 0);
+  entry.stage_us[kArUpdate] = ar_update_us_;
+  entry.stage_us[kPoseSent] = now_us;
+}
+
+void LatencyTracker::OnPosePickup(uint64_t pose_id, int64_t now_us) {
+  // The server may fetch the same pose more than once, keep the first.
+  Entry& entry = entries_[pose_id % kCapacity];
+  if (entry.pickup_pose_id.load() == pose_id) {
+    return;
+  }
+
+  // Time first, so a reader that sees the new ID also sees its time.
+  entry.pickup_us.store(now_us);
+  entry.pickup_pose_id.store(pose_id);
+}
+
+void LatencyTracker::OnFrameLatched(uint64_t pose_id, int64_t now_us) {
+  Entry* entry = Find(pose_id);
+  if (entry && entry->stage_us[kFrameLatched] == 0) {
+    entry->stage_us[kFrameLatched] = now_us;
+  }
+}
+
+void LatencyTracker::OnFrameBlitted(uint64_t pose_id, int64_t now_us) {
+  Entry* entry = Find(pose_id);
+  if (entry && entry->stage_us[kFrameBlitted] == 0) {
+    entry->stage_us[kFrameBlitted] = now_us;
+    blitted_pose_id_ = pose_id;
+  }
+}
+
+void LatencyTracker::OnFrameSwapped(int64_t now_us) {
+  if (blitted_pose_id_ == 0) {
+    return;
+  }
+
+  Entry* entry = Find(blitted_pose_id_);
+  blitted_pose_id_ = 0;
+  if (!entry) {
+    return;
+  }
+
+  entry->stage_us[kFrameSwapped] = now_us;
+  if (!ReadPickup(*entry, &entry->stage_us[kPosePickup])) {
+    return;  // the callback lost track of it, skip rather than guess.
+  }
+  Complete(*entry);
+}
+
+LatencyTracker::Entry* LatencyTracker::Find(uint64_t pose_id) {
+  Entry& entry = entries_[pose_id % kCapacity];
+  return (pose_id != 0 && entry.pose_id == pose_id) ? &entry : nullptr;
+}
+
+bool LatencyTracker::ReadPickup(const Entry& entry, int64_t* pickup_us) const {
+  // Re-check the ID after reading the time, in case a later pose landing in
+  // the same slot was picked up meanwhile.
+  const uint64_t before = entry.pickup_pose_id.load();
+  const int64_t us = entry.pickup_us.load();
+  const uint64_t after = entry.pickup_pose_id.load();
+  if (before != entry.pose_id || after != entry.pose_id) {
+    return false;
+  }
+
+  *pickup_us = us;
+  return true;
+}
+
+void LatencyTracker::Complete(const Entry& entry) {
+  const int64_t* stage_us = entry.stage_us;
+  if (stage_us[kArUpdate] == 0 || stage_us[kFrameLatched] == 0) {
+    return;
+  }
+
+  histograms_[0].Add(stage_us[kFrameSwapped] - stage_us[kArUpdate]);
+  for (int stage = 1; stage < kNumStages; stage++) {
+    histograms_[stage].Add(stage_us[stage] - stage_us[stage - 1]);
+  }
+
+  if (trace_file_) {
+    TraceRecord record;
+    record.pose_id = entry.pose_id;
+    std::memcpy(record.stage_us, stage_us, sizeof(record.stage_us));
+    trace_records_.push_back(record);
+  }
+}
+
+bool LatencyTracker::OpenTrace(const std::string& path) {
+  if (trace_file_) {
+    return true;  // keep appending across reconnects.
+  }
+
+  trace_file_ = fopen(path.c_str(), "wb");
+  if (!trace_file_) {
+    CXR_LOGE("Could not open latency trace %s", path.c_str());
+    return false;
+  }
+
+  const uint32_t header[2] = {kNumStages, sizeof(TraceRecord)};
+  fwrite(kTraceMagic, sizeof(kTraceMagic), 1, trace_file_);
+  fwrite(header, sizeof(header), 1, trace_file_);
+  CXR_LOGI("Writing latency trace to %s", path.c_str());
+  return true;
+}
+
+void LatencyTracker::CloseTrace() {
+  if (!trace_file_) {
+    return;
+  }
+
+  FlushTrace();
+  fclose(trace_file_);
+  trace_file_ = nullptr;
+}
+
+void LatencyTracker::FlushTrace() {
+  if (!trace_file_ || trace_records_.empty()) {
+    return;
+  }
+
+  fwrite(trace_records_.data(), sizeof(TraceRecord), trace_records_.size(),
+         trace_file_);
+  fflush(trace_file_);
+  trace_records_.clear();
+}
+
+void LatencyTracker::LogReport() {
+  if (histograms_[0].count == 0) {
+    return;
+  }
+
+  CXR_LOGI("Latency over %u frames (ms, p50/p90/p99/max):",
+           histograms_[0].count);
+  for (int stage = 0; stage < kNumStages; stage++) {
+    const Histogram& histogram = histograms_[stage];
+    CXR_LOGI("  %-6s %6.1f %6.1f %6.1f %6.1f", kIntervalNames[stage],
+             histogram.PercentileMs(0.5f), histogram.PercentileMs(0.9f),
+             histogram.PercentileMs(0.99f), histogram.max_us / 1000.0f);
+  }
+
+  for (Histogram& histogram : histograms_) {
+    histogram.Clear();
+  }
+  FlushTrace();
+}
+
+void LatencyTracker::Histogram::Add(int64_t us) {
+  us = std::max<int64_t>(us, 0);
+  const int bucket = static_cast<int>(std::min<int64_t>(us / kBucketUs,
+                                                        kNumBuckets - 1));
+  buckets[bucket]++;
+  count++;
+  max_us = std::max(max_us, us);
+}
+
+float LatencyTracker::Histogram::PercentileMs(float percentile) const {
+  const uint32_t target = static_cast<uint32_t>(percentile * count);
+  uint32_t seen = 0;
+  for (int bucket = 0; bucket < kNumBuckets; bucket++) {
+    seen += buckets[bucket];
+    if (seen > target) {
+      return std::min<int64_t>((bucket + 1) * kBucketUs, max_us) / 1000.0f;
+    }
+  }
+  return max_us / 1000.0f;
+}
+
+void LatencyTracker::Histogram::Clear() {
+  buckets.fill(0);
+  count = 0;
+  max_us = 0;
+}
+
+}  // namespace hello_ar
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_LATENCY_TRACKER_H_
+#define C_ARCORE_HELLO_AR_LATENCY_TRACKER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace hello_ar {
+
+// Follows each pose sent to the server through the client pipeline, keyed by
+// the pose ID the server echoes back with the frame rendered from it:
+//
+//   ArSession_update -> SetPoseMatrix -> GetTrackingState pickup ->
+//   cxrLatchFrame -> cxrBlitFrame -> end of OnDrawFrame
+//
+// The time spent between stages goes into per-stage histograms, logged with
+// LogReport(), and optionally into a binary trace file with one record per
+// displayed frame.
+//
+// OnPosePickup() is called on the CloudXR callback thread, everything else on
+// the GL thread.  Times are in microseconds from util::NowUs().
+class LatencyTracker {
+ public:
+  enum Stage {
+    kArUpdate,
+    kPoseSent,
+    kPosePickup,
+    kFrameLatched,
+    kFrameBlitted,
+    kFrameSwapped,
+    kNumStages
+  };
+
+  LatencyTracker() = default;
+  ~LatencyTracker();
+
+  void OnArUpdate(int64_t now_us);
+  void OnPoseSent(uint64_t pose_id, int64_t now_us);
+  void OnPosePickup(uint64_t pose_id, int64_t now_us);
+  void OnFrameLatched(uint64_t pose_id, int64_t now_us);
+  void OnFrameBlitted(uint64_t pose_id, int64_t now_us);
+  // Completes the frame blitted since the last call.  The buffer swap itself
+  // happens in GLSurfaceView after OnDrawFrame returns, so this is a close
+  // approximation rather than the true present time.
+  void OnFrameSwapped(int64_t now_us);
+
+  // Starts writing completed frames to path, replacing any existing file.
+  // Does nothing if a trace is already open.
+  // @return false if the file could not be opened.
+  bool OpenTrace(const std::string& path);
+  void CloseTrace();
+
+  // Logs percentiles of each stage since the last report, and flushes the
+  // trace file.
+  void LogReport();
+
+  // Delete copy constructors.
+  LatencyTracker(const LatencyTracker&) = delete;
+  void operator=(const LatencyTracker&) = delete;
+
+ private:
+  // Poses in flight, comfortably more than a 500ms round trip at 60Hz.
+  static constexpr int kCapacity = 64;
+
+  // 0.5ms buckets up to 256ms, the last one collects anything slower.
+  static constexpr int kBucketUs = 500;
+  static constexpr int kNumBuckets = 512;
+
+  struct Histogram {
+    std::array<uint32_t, kNumBuckets> buckets = {};
+    uint32_t count = 0;
+    int64_t max_us = 0;
+
+    void Add(int64_t us);
+    // @return the upper edge of the bucket holding the given percentile,
+    // capped at the maximum seen.
+    float PercentileMs(float percentile) const;
+    void Clear();
+  };
+
+  struct Entry {
+    uint64_t pose_id = 0;
+    int64_t stage_us[kNumStages] = {};
+
+    // Written by the callback thread, see OnPosePickup().
+    std::atomic<uint64_t> pickup_pose_id{0};
+    std::atomic<int64_t> pickup_us{0};
+  };
+
+  // One record of the trace file.
+  struct TraceRecord {
+    uint64_t pose_id;
+    int64_t stage_us[kNumStages];
+  };
+
+  Entry* Find(uint64_t pose_id);
+  bool ReadPickup(const Entry& entry, int64_t* pickup_us) const;
+  void Complete(const Entry& entry);
+  void FlushTrace();
+
+  std::array<Entry, kCapacity> entries_;
+  int64_t ar_update_us_ = 0;
+  uint64_t blitted_pose_id_ = 0;
+
+  // Intervals from each stage to the next, plus the whole pipeline.
+  std::array<Histogram, kNumStages> histograms_;
+
+  FILE* trace_file_ = nullptr;
+  std::vector<TraceRecord> trace_records_;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_LATENCY_TRACKER_H_
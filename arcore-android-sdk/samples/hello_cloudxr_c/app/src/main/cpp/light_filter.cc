@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "light_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CloudXRLog.h"
+
+namespace hello_ar {
+namespace {
+float Length(const cxrVector3& v) {
+  return sqrtf(v.v[0] * v.v[0] + v.v[1] * v.v[1] + v.v[2] * v.v[2]);
+}
+
+void Blend(const cxrVector3& target, float weight, cxrVector3* value) {
+  for (int i = 0; i < 3; i++) {
+    value->v[i] += weight * (target.v[i] - value->v[i]);
+  }
+}
+
+// Largest change of one channel, relative to the brightest channel.
+float ColorChange(const cxrVector3& a, const cxrVector3& b) {
+  float change = 0.0f;
+  float brightest = 1e-6f;
+  for (int i = 0; i < 3; i++) {
+    change = std::max(change, fabsf(a.v[i] - b.v[i]));
+    brightest = std::max(brightest, fabsf(b.v[i]));
+  }
+  return change / brightest;
+}
+}  // namespace
+
+void LightFilter::Reset() {
+  valid_ = false;
+  last_update_us_ = 0;
+  last_send_us_ = 0;
+}
+
+bool LightFilter::Update(const cxrLightProperties& estimate, int64_t now_us) {
+  estimates_++;
+
+  if (!valid_) {
+    smoothed_ = estimate;
+    valid_ = true;
+  } else {
+    // Frame rate independent exponential smoothing.
+    const float weight = 1.0f - expf(-(now_us - last_update_us_) / kSmoothingUs);
+    Blend(estimate.primaryLightColor, weight, &smoothed_.primaryLightColor);
+    Blend(estimate.primaryLightDirection, weight, &smoothed_.primaryLightDirection);
+    for (int i = 0; i < CXR_MAX_AMBIENT_LIGHT_SH; i++) {
+      Blend(estimate.ambientLightSh[i], weight, &smoothed_.ambientLightSh[i]);
+    }
+
+    const float length = Length(smoothed_.primaryLightDirection);
+    if (length > 0.0f) {
+      for (int i = 0; i < 3; i++) {
+        smoothed_.primaryLightDirection.v[i] /= length;
+      }
+    }
+  }
+  last_update_us_ = now_us;
+
+  const int64_t since_send_us = now_us - last_send_us_;
+  if (last_send_us_ != 0 && since_send_us < kMaxIntervalUs &&
+      (since_send_us < kMinIntervalUs || !HasChanged())) {
+    return false;
+  }
+
+  sent_ = smoothed_;
+  last_send_us_ = now_us;
+  sends_++;
+  return true;
+}
+
+bool LightFilter::HasChanged() const {
+  const cxrVector3& a = smoothed_.primaryLightDirection;
+  const cxrVector3& b = sent_.primaryLightDirection;
+  const float cos_angle = (a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]) /
+      std::max(Length(a) * Length(b), 1e-6f);
+  if (cos_angle < cosf(kMaxAngleDeg * static_cast<float>(M_PI) / 180.0f)) {
+    return true;
+  }
+
+  if (ColorChange(smoothed_.primaryLightColor, sent_.primaryLightColor) > kMaxColorChange) {
+    return true;
+  }
+
+  // Compare the ambient light as a whole, relative to its overall energy.
+  float difference = 0.0f;
+  float energy = 1e-6f;
+  for (int i = 0; i < CXR_MAX_AMBIENT_LIGHT_SH; i++) {
+    for (int c = 0; c < 3; c++) {
+      const float delta = smoothed_.ambientLightSh[i].v[c] - sent_.ambientLightSh[i].v[c];
+      difference += delta * delta;
+      energy += sent_.ambientLightSh[i].v[c] * sent_.ambientLightSh[i].v[c];
+    }
+  }
+  return sqrtf(difference / energy) > kMaxAmbientChange;
+}
+
+void LightFilter::LogReport() {
+  CXR_LOGI("Light estimate: sent %u of %u", sends_, estimates_);
+  sends_ = 0;
+  estimates_ = 0;
+}
+
+}  // namespace hello_ar
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_LIGHT_FILTER_H_
+#define C_ARCORE_HELLO_AR_LIGHT_FILTER_H_
+
+#include <cstdint>
+
+#include "CloudXRClient.h"
+
+namespace hello_ar {
+
+// Smooths ARCore's per-frame HDR light estimate, and decides when it has
+// changed enough since the last send to be worth sending to the server again.
+//
+// The estimate drifts slowly, so most frames send nothing.  Sends are spaced
+// at least kMinIntervalUs apart, and repeated at least every kMaxIntervalUs
+// so the server catches up after a reconnect.  Use from the GL thread only.
+class LightFilter {
+ public:
+  LightFilter() = default;
+  ~LightFilter() = default;
+
+  // Forgets the smoothed estimate, so the next one is sent right away.
+  void Reset();
+
+  // Blends in a new estimate.  Times are in microseconds from util::NowUs().
+  // @return true if GetSmoothed() should be sent now.
+  bool Update(const cxrLightProperties& estimate, int64_t now_us);
+
+  const cxrLightProperties& GetSmoothed() const { return smoothed_; }
+
+  // Logs how many estimates were sent since the last report.
+  void LogReport();
+
+ private:
+  // Time constant of the smoothing.
+  static constexpr float kSmoothingUs = 250000.0f;
+  static constexpr int64_t kMinIntervalUs = 100000;
+  static constexpr int64_t kMaxIntervalUs = 1000000;
+  // Changes smaller than these are too small to see.
+  static constexpr float kMaxAngleDeg = 3.0f;
+  static constexpr float kMaxColorChange = 0.05f;
+  static constexpr float kMaxAmbientChange = 0.05f;
+
+  bool HasChanged() const;
+
+  cxrLightProperties smoothed_ = {};
+  cxrLightProperties sent_ = {};
+  bool valid_ = false;
+  int64_t last_update_us_ = 0;
+  int64_t last_send_us_ = 0;
+
+  uint32_t estimates_ = 0;
+  uint32_t sends_ = 0;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_LIGHT_FILTER_H_
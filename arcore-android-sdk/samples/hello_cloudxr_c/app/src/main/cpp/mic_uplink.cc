@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "mic_uplink.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "CloudXRLog.h"
+
+namespace hello_ar {
+
+constexpr float MicUplink::kMinVoiceDb;
+
+MicUplink::MicUplink(SendFn send) : send_(std::move(send)) {}
+
+void MicUplink::Reset(int32_t sample_rate, int32_t packet_ms, bool suppress_silence) {
+  packet_frames_ = sample_rate * packet_ms / 1000;
+  packets_.assign(2 * packet_frames_ * kChannels, 0);
+  current_ = 0;
+  filled_frames_ = 0;
+  previous_sent_ = true;
+
+  suppress_silence_ = suppress_silence;
+  noise_floor_valid_ = false;
+  noise_rise_db_ = kNoiseRiseDbPerSec * packet_ms / 1000.0f;
+  hangover_packets_ = kHangoverMs / packet_ms;
+  hangover_left_ = 0;
+
+  sent_packets_.store(0);
+  suppressed_packets_.store(0);
+}
+
+void MicUplink::Push(const int16_t* samples, int32_t frames) {
+  while (frames > 0 && packet_frames_ > 0) {
+    const int32_t copied = std::min(frames, packet_frames_ - filled_frames_);
+    int16_t* packet = &packets_[current_ * packet_frames_ * kChannels];
+    memcpy(packet + filled_frames_ * kChannels, samples,
+           copied * kChannels * sizeof(int16_t));
+    filled_frames_ += copied;
+    samples += copied * kChannels;
+    frames -= copied;
+
+    if (filled_frames_ == packet_frames_) {
+      OnPacketFilled();
+    }
+  }
+}
+
+void MicUplink::OnPacketFilled() {
+  const int16_t* packet = &packets_[current_ * packet_frames_ * kChannels];
+  const int16_t* previous = &packets_[(1 - current_) * packet_frames_ * kChannels];
+
+  bool send = true;
+  if (suppress_silence_) {
+    if (IsVoice(packet)) {
+      hangover_left_ = hangover_packets_;
+    } else if (hangover_left_ > 0) {
+      hangover_left_--;
+    } else {
+      send = false;
+    }
+  }
+
+  if (send) {
+    if (!previous_sent_) {
+      send_(previous, packet_frames_);
+      sent_packets_.fetch_add(1, std::memory_order_relaxed);
+    }
+    send_(packet, packet_frames_);
+    sent_packets_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    suppressed_packets_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  previous_sent_ = send;
+  current_ = 1 - current_;
+  filled_frames_ = 0;
+}
+
+bool MicUplink::IsVoice(const int16_t* packet) {
+  const int32_t count = packet_frames_ * kChannels;
+  float sum_squares = 0.0f;
+  for (int32_t i = 0; i < count; i++) {
+    const float sample = packet[i] / 32768.0f;
+    sum_squares += sample * sample;
+  }
+  const float level_db = 10.0f * log10f(sum_squares / count + 1e-10f);
+
+  if (!noise_floor_valid_ || level_db < noise_floor_db_) {
+    noise_floor_db_ = level_db;
+    noise_floor_valid_ = true;
+  } else {
+    noise_floor_db_ = std::min(level_db, noise_floor_db_ + noise_rise_db_);
+  }
+
+  return level_db > std::max(noise_floor_db_ + kVoiceAboveNoiseDb, kMinVoiceDb);
+}
+
+void MicUplink::LogReport() {
+  const uint32_t sent = sent_packets_.exchange(0, std::memory_order_relaxed);
+  const uint32_t suppressed = suppressed_packets_.exchange(0, std::memory_order_relaxed);
+  CXR_LOGI("Mic uplink: sent %u packets, suppressed %u silent (%.0f%%)", sent, suppressed,
+           sent + suppressed ? 100.0f * suppressed / (sent + suppressed) : 0.0f);
+}
+
+}  // namespace hello_ar
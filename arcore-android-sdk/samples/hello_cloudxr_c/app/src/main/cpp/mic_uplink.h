@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_MIC_UPLINK_H_
+#define C_ARCORE_HELLO_AR_MIC_UPLINK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace hello_ar {
+
+// Collects microphone bursts of whatever size the audio device delivers into
+// fixed-length packets, and passes on only the ones that carry voice.
+//
+// Voice is detected by packet energy against a tracked noise floor.  Sending
+// carries on for a hangover after the voice stops, so word endings aren't
+// clipped, and the packet before an onset goes out too, so beginnings aren't.
+//
+// Samples are interleaved 16-bit stereo.  Not thread safe, call Push() from
+// the recording callback only.  LogReport() may be called from any thread.
+class MicUplink {
+ public:
+  static constexpr int kChannels = 2;
+
+  // Sends one packet, valid only for the duration of the call.
+  using SendFn = std::function<void(const int16_t* samples, int32_t frames)>;
+
+  explicit MicUplink(SendFn send);
+  ~MicUplink() = default;
+
+  // Drops any partial packet and forgets the noise floor.  Allocates, so
+  // call before recording starts.
+  // @param suppress_silence: false to send every packet.
+  void Reset(int32_t sample_rate, int32_t packet_ms, bool suppress_silence);
+
+  void Push(const int16_t* samples, int32_t frames);
+
+  // Logs sent and suppressed packet counts since the last report.
+  void LogReport();
+
+  // Delete copy constructors.
+  MicUplink(const MicUplink&) = delete;
+  void operator=(const MicUplink&) = delete;
+
+ private:
+  // Voice is this much louder than the noise floor, and no quieter than the
+  // absolute minimum, in dBFS.
+  static constexpr float kVoiceAboveNoiseDb = 10.0f;
+  static constexpr float kMinVoiceDb = -60.0f;
+  // How fast the noise floor may rise, so it follows a louder room but not
+  // someone talking.  It falls to a quieter level right away.
+  static constexpr float kNoiseRiseDbPerSec = 2.0f;
+  static constexpr int32_t kHangoverMs = 200;
+
+  bool IsVoice(const int16_t* packet);
+  void OnPacketFilled();
+
+  SendFn send_;
+
+  // Two packets, the one being filled and the one before it.
+  std::vector<int16_t> packets_;
+  int32_t packet_frames_ = 0;
+  int32_t current_ = 0;
+  int32_t filled_frames_ = 0;
+  bool previous_sent_ = true;
+
+  bool suppress_silence_ = true;
+  float noise_floor_db_ = 0.0f;
+  bool noise_floor_valid_ = false;
+  float noise_rise_db_ = 0.0f;
+  int32_t hangover_packets_ = 0;
+  int32_t hangover_left_ = 0;
+
+  std::atomic<uint32_t> sent_packets_{0};
+  std::atomic<uint32_t> suppressed_packets_{0};
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_MIC_UPLINK_H_
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "plane_batch.h"
+
+namespace hello_ar {
+
+void PlaneBatch::Clear() {
+  vertices_.clear();
+  indices_.clear();
+}
+
+void PlaneBatch::Add(const std::vector<glm::vec3>& local_vertices,
+                     const std::vector<uint16_t>& local_indices,
+                     const glm::mat4& model_mat, const glm::vec3& normal) {
+  const uint32_t base = vertices_.size();
+
+  for (const glm::vec3& local : local_vertices) {
+    const glm::vec4 world = model_mat * glm::vec4(local.x, 0.0f, local.y, 1.0f);
+    vertices_.push_back({glm::vec3(world), local.z, normal});
+  }
+
+  for (const uint16_t index : local_indices) {
+    indices_.push_back(base + index);
+  }
+}
+
+}  // namespace hello_ar
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_PLANE_BATCH_H_
+#define C_ARCORE_HELLO_AR_PLANE_BATCH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "glm.h"
+
+namespace hello_ar {
+
+// Packs the meshes of any number of planes into one vertex and index array,
+// in world space, so they can all be drawn with a single call.
+//
+// Makes no GL or ARCore calls.  The arrays keep their storage across Clear(),
+// so a steady set of planes packs without allocating.
+class PlaneBatch {
+ public:
+  struct Vertex {
+    glm::vec3 position;  // world space
+    float alpha;         // 0 on the polygon edge, 1 inside the feather
+    glm::vec3 normal;    // world space normal of the vertex's plane
+  };
+
+  PlaneBatch() = default;
+  ~PlaneBatch() = default;
+
+  void Clear();
+
+  // Appends one plane.
+  //
+  // @param local_vertices, polygon vertices in the plane's space, with the
+  //   plane's x and z in .x and .y, and alpha in .z.
+  // @param local_indices, triangles indexing local_vertices.
+  // @param model_mat, the plane's center pose.
+  // @param normal, the plane's normal in world space.
+  void Add(const std::vector<glm::vec3>& local_vertices,
+           const std::vector<uint16_t>& local_indices,
+           const glm::mat4& model_mat, const glm::vec3& normal);
+
+  bool IsEmpty() const { return indices_.empty(); }
+  const std::vector<Vertex>& GetVertices() const { return vertices_; }
+  const std::vector<uint32_t>& GetIndices() const { return indices_; }
+
+ private:
+  std::vector<Vertex> vertices_;
+  std::vector<uint32_t> indices_;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_PLANE_BATCH_H_
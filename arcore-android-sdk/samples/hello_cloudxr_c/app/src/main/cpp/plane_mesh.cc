@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "plane_mesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PLANE_MESH_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PLANE_MESH_SSE2 1
+#endif
+
+namespace hello_ar {
+namespace {
+// Four inner ring vertices at a time, returns how many were done.
+int32_t FeatherSimd(const float* polygon, int32_t polygon_size,
+                    float feather_length, float feather_scale, float* inner) {
+  int32_t i = 0;
+#if PLANE_MESH_NEON
+  const float32x4_t length = vdupq_n_f32(feather_length);
+  const float32x4_t max_scale = vdupq_n_f32(feather_scale);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  for (; i + 4 <= polygon_size; i += 4) {
+    // Deinterleaves into x0..x3 and y0..y3.
+    const float32x4x2_t xy = vld2q_f32(polygon + 2 * i);
+    const float32x4_t distance = vsqrtq_f32(
+        vaddq_f32(vmulq_f32(xy.val[0], xy.val[0]), vmulq_f32(xy.val[1], xy.val[1])));
+    const float32x4_t scale =
+        vsubq_f32(one, vminq_f32(vdivq_f32(length, distance), max_scale));
+    float32x4x3_t vertices;
+    vertices.val[0] = vmulq_f32(xy.val[0], scale);
+    vertices.val[1] = vmulq_f32(xy.val[1], scale);
+    vertices.val[2] = one;
+    vst3q_f32(inner + 3 * i, vertices);
+  }
+#elif PLANE_MESH_SSE2
+  const __m128 length = _mm_set1_ps(feather_length);
+  const __m128 max_scale = _mm_set1_ps(feather_scale);
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= polygon_size; i += 4) {
+    const __m128 xy01 = _mm_loadu_ps(polygon + 2 * i);
+    const __m128 xy23 = _mm_loadu_ps(polygon + 2 * i + 4);
+    const __m128 x = _mm_shuffle_ps(xy01, xy23, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 y = _mm_shuffle_ps(xy01, xy23, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 distance =
+        _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+    const __m128 scale =
+        _mm_sub_ps(one, _mm_min_ps(_mm_div_ps(length, distance), max_scale));
+
+    // No interleaving store, write the x, y, alpha triples one by one.
+    alignas(16) float inner_x[4];
+    alignas(16) float inner_y[4];
+    _mm_store_ps(inner_x, _mm_mul_ps(x, scale));
+    _mm_store_ps(inner_y, _mm_mul_ps(y, scale));
+    for (int lane = 0; lane < 4; ++lane) {
+      float* vertex = inner + 3 * (i + lane);
+      vertex[0] = inner_x[lane];
+      vertex[1] = inner_y[lane];
+      vertex[2] = 1.0f;
+    }
+  }
+#endif
+  return i;
+}
+}  // namespace
+
+void BuildFeatheredMesh(const glm::vec2* polygon, int32_t polygon_size,
+                        float feather_length, float feather_scale,
+                        glm::vec3* out_vertices, uint16_t* out_indices) {
+  // The indices used below, for a four sided polygon:
+  // _______________     0_______________1
+  // |             |      |4___________5|
+  // |             |      | |         | |
+  // |             | =>   | |         | |
+  // |             |      | |         | |
+  // |             |      |7-----------6|
+  // ---------------     3---------------2
+  const int32_t n = polygon_size;
+
+  // Vertex 0 to 3, the polygon with alpha 0.
+  for (int32_t i = 0; i < n; ++i) {
+    out_vertices[i] = glm::vec3(polygon[i].x, polygon[i].y, 0.0f);
+  }
+
+  // Vertex 4 to 7, with alpha 1.  The SIMD kernel leaves any remainder.
+  glm::vec3* inner = out_vertices + n;
+  int32_t i = FeatherSimd(glm::value_ptr(polygon[0]), n, feather_length,
+                          feather_scale, glm::value_ptr(inner[0]));
+  for (; i < n; ++i) {
+    const glm::vec2 v = polygon[i];
+    const float distance = sqrtf(v.x * v.x + v.y * v.y);
+    const float scale = 1.0f - std::min(feather_length / distance, feather_scale);
+    inner[i] = glm::vec3(scale * v.x, scale * v.y, 1.0f);
+  }
+
+  // Triangles (4, 5, 6) and (4, 6, 7).
+  uint16_t* index = out_indices;
+  for (int32_t j = n + 1; j < 2 * n - 1; ++j) {
+    index[0] = n;
+    index[1] = j;
+    index[2] = j + 1;
+    index += 3;
+  }
+
+  // Triangles (0, 1, 4), (4, 1, 5), (5, 1, 2), (5, 2, 6), (6, 2, 3),
+  // (6, 3, 7), (7, 3, 0) and (7, 0, 4).
+  for (int32_t j = 0; j < n; ++j) {
+    const int32_t next = j + 1 == n ? 0 : j + 1;
+    index[0] = j;
+    index[1] = next;
+    index[2] = j + n;
+    index[3] = j + n;
+    index[4] = next;
+    index[5] = next + n;
+    index += 6;
+  }
+}
+
+}  // namespace hello_ar
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_PLANE_MESH_H_
+#define C_ARCORE_HELLO_AR_PLANE_MESH_H_
+
+#include <cstdint>
+
+#include "glm.h"
+
+namespace hello_ar {
+
+// Number of vertices and indices BuildFeatheredMesh() writes for a polygon of
+// polygon_size vertices.
+inline int32_t FeatheredVertexCount(int32_t polygon_size) {
+  return 2 * polygon_size;
+}
+inline int32_t FeatheredIndexCount(int32_t polygon_size) {
+  return 3 * (polygon_size > 2 ? polygon_size - 2 : 0) + 6 * polygon_size;
+}
+
+// Triangulates a convex plane polygon, with a feathered edge for blending.
+//
+// The outer ring is the polygon itself, with alpha 0.  The inner ring pulls
+// each vertex toward the center by feather_length, but by no more than
+// feather_scale of its distance from the center, with alpha 1.  The inner
+// ring is filled with a fan, and the feather with a strip.
+//
+// Vertices hold the plane's x and z in .x and .y, and alpha in .z.  Uses
+// NEON or SSE2 for the inner ring where available.
+//
+// @param out_vertices, room for FeatheredVertexCount(polygon_size) vertices.
+// @param out_indices, room for FeatheredIndexCount(polygon_size) indices.
+void BuildFeatheredMesh(const glm::vec2* polygon, int32_t polygon_size,
+                        float feather_length, float feather_scale,
+                        glm::vec3* out_vertices, uint16_t* out_indices);
+
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_PLANE_MESH_H_
@@ -15,13 +15,27 @@
  */
 
 #include "plane_renderer.h"
+#include <cstddef>
 #include <string>
+#include "plane_mesh.h"
+#include "trace.h"
 #include "util.h"
 
 namespace hello_ar {
 namespace {
 constexpr char kVertexShaderFilename[] = "shaders/plane.vert";
 constexpr char kFragmentShaderFilename[] = "shaders/plane.frag";
+
+// FNV-1a over the raw polygon floats.
+uint64_t HashPolygon(const std::vector<glm::vec2>& polygon) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(polygon.data());
+  const size_t size = polygon.size() * sizeof(glm::vec2);
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
 }  // namespace
 
 void PlaneRenderer::InitializeGlContent(AAssetManager* asset_manager) {
@@ -31,12 +45,16 @@ void PlaneRenderer::InitializeGlContent(AAssetManager* asset_manager) {
     CXR_LOGE("Could not create program.");
   }
 
-  uniform_mvp_mat_ = glGetUniformLocation(shader_program_, "mvp");
+  uniform_view_projection_mat_ =
+      glGetUniformLocation(shader_program_, "view_projection");
   uniform_texture_ = glGetUniformLocation(shader_program_, "texture");
-  uniform_model_mat_ = glGetUniformLocation(shader_program_, "model_mat");
-  uniform_normal_vec_ = glGetUniformLocation(shader_program_, "normal");
   uniform_color_ = glGetUniformLocation(shader_program_, "color");
-  attri_vertices_ = glGetAttribLocation(shader_program_, "vertex");
+  attri_position_ = glGetAttribLocation(shader_program_, "position");
+  attri_alpha_ = glGetAttribLocation(shader_program_, "alpha");
+  attri_normal_ = glGetAttribLocation(shader_program_, "normal");
+
+  glGenBuffers(1, &vertex_buffer_);
+  glGenBuffers(1, &index_buffer_);
 
   glGenTextures(1, &texture_id_);
   glBindTexture(GL_TEXTURE_2D, texture_id_);
@@ -57,15 +75,52 @@ void PlaneRenderer::InitializeGlContent(AAssetManager* asset_manager) {
   util::CheckGlError("plane_renderer::InitializeGlContent()");
 }
 
+void PlaneRenderer::AddPlane(const ArSession& ar_session,
+                             const ArPlane& ar_plane, ArPose* scratch_pose) {
+  int32_t polygon_length;
+  ArPlane_getPolygonSize(&ar_session, &ar_plane, &polygon_length);
+
+  if (polygon_length == 0) {
+    CXR_LOGE("PlaneRenderer::AddPlane, no valid plane polygon is found");
+    return;
+  }
+
+  raw_vertices_.resize(polygon_length / 2);
+  ArPlane_getPolygon(&ar_session, &ar_plane,
+                     glm::value_ptr(raw_vertices_.front()));
+
+  PlaneMesh& mesh = meshes_[&ar_plane];
+  mesh.last_used_frame = frame_;
+
+  const uint64_t polygon_hash = HashPolygon(raw_vertices_);
+  if (mesh.polygon_length != polygon_length ||
+      mesh.polygon_hash != polygon_hash) {
+    BuildMesh(&mesh);
+    mesh.polygon_length = polygon_length;
+    mesh.polygon_hash = polygon_hash;
+  }
+
+  // The plane moves as tracking improves, even when its polygon doesn't.
+  glm::mat4 model_mat;
+  ArPlane_getCenterPose(&ar_session, &ar_plane, scratch_pose);
+  ArPose_getMatrix(&ar_session, scratch_pose, glm::value_ptr(model_mat));
+  const glm::vec3 normal = util::GetPlaneNormal(ar_session, *scratch_pose);
+
+  batch_.Add(mesh.vertices, mesh.triangles, model_mat, normal);
+}
+
 void PlaneRenderer::Draw(const glm::mat4& projection_mat,
-                         const glm::mat4& view_mat, const ArSession& ar_session,
-                         const ArPlane& ar_plane, const glm::vec3& color) {
+                         const glm::mat4& view_mat, const glm::vec3& color) {
+  TRACE_SCOPE("PlaneRenderer::Draw");
   if (!shader_program_) {
     CXR_LOGE("shader_program is null.");
+    batch_.Clear();
     return;
   }
 
-  UpdateForPlane(ar_session, ar_plane);
+  if (batch_.IsEmpty()) {
+    return;
+  }
 
   glUseProgram(shader_program_);
   glDepthMask(GL_FALSE);
@@ -74,108 +129,70 @@ void PlaneRenderer::Draw(const glm::mat4& projection_mat,
   glUniform1i(uniform_texture_, 0);
   glBindTexture(GL_TEXTURE_2D, texture_id_);
 
-  // Compose final mvp matrix for this plane renderer.
-  glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE,
-                     glm::value_ptr(projection_mat * view_mat * model_mat_));
-
-  glUniformMatrix4fv(uniform_model_mat_, 1, GL_FALSE,
-                     glm::value_ptr(model_mat_));
-  glUniform3f(uniform_normal_vec_, normal_vec_.x, normal_vec_.y, normal_vec_.z);
+  // Vertices are already in world space.
+  glUniformMatrix4fv(uniform_view_projection_mat_, 1, GL_FALSE,
+                     glm::value_ptr(projection_mat * view_mat));
   glUniform3f(uniform_color_, color.x, color.y, color.z);
 
-  glEnableVertexAttribArray(attri_vertices_);
-  glVertexAttribPointer(attri_vertices_, 3, GL_FLOAT, GL_FALSE, 0,
-                        vertices_.data());
-
-  glDrawElements(GL_TRIANGLES, triangles_.size(), GL_UNSIGNED_SHORT,
-                 triangles_.data());
-
+  const std::vector<PlaneBatch::Vertex>& vertices = batch_.GetVertices();
+  const std::vector<uint32_t>& indices = batch_.GetIndices();
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(PlaneBatch::Vertex),
+               vertices.data(), GL_STREAM_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t),
+               indices.data(), GL_STREAM_DRAW);
+
+  const GLsizei stride = sizeof(PlaneBatch::Vertex);
+  glEnableVertexAttribArray(attri_position_);
+  glVertexAttribPointer(attri_position_, 3, GL_FLOAT, GL_FALSE, stride,
+      reinterpret_cast<const void*>(offsetof(PlaneBatch::Vertex, position)));
+  glEnableVertexAttribArray(attri_alpha_);
+  glVertexAttribPointer(attri_alpha_, 1, GL_FLOAT, GL_FALSE, stride,
+      reinterpret_cast<const void*>(offsetof(PlaneBatch::Vertex, alpha)));
+  glEnableVertexAttribArray(attri_normal_);
+  glVertexAttribPointer(attri_normal_, 3, GL_FLOAT, GL_FALSE, stride,
+      reinterpret_cast<const void*>(offsetof(PlaneBatch::Vertex, normal)));
+
+  glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
+
+  // the other renderers draw from client memory.
+  glDisableVertexAttribArray(attri_position_);
+  glDisableVertexAttribArray(attri_alpha_);
+  glDisableVertexAttribArray(attri_normal_);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
   glUseProgram(0);
   glDepthMask(GL_TRUE);
   util::CheckGlError("plane_renderer::Draw()");
-}
-
-void PlaneRenderer::UpdateForPlane(const ArSession& ar_session,
-                                   const ArPlane& ar_plane) {
-  // The following code generates a triangle mesh filling a convex polygon,
-  // including a feathered edge for blending.
-  //
-  // The indices shown in the diagram are used in comments below.
-  // _______________     0_______________1
-  // |             |      |4___________5|
-  // |             |      | |         | |
-  // |             | =>   | |         | |
-  // |             |      | |         | |
-  // |             |      |7-----------6|
-  // ---------------     3---------------2
-
-  vertices_.clear();
-  triangles_.clear();
-
-  int32_t polygon_length;
-  ArPlane_getPolygonSize(&ar_session, &ar_plane, &polygon_length);
-
-  if (polygon_length == 0) {
-    CXR_LOGE("PlaneRenderer::UpdatePlane, no valid plane polygon is found");
-    return;
-  }
 
-  const int32_t vertices_size = polygon_length / 2;
-  std::vector<glm::vec2> raw_vertices(vertices_size);
-  ArPlane_getPolygon(&ar_session, &ar_plane,
-                     glm::value_ptr(raw_vertices.front()));
+  batch_.Clear();
+}
 
-  // Fill vertex 0 to 3. Note that the vertex.xy are used for x and z
-  // position. vertex.z is used for alpha. The outter polygon's alpha
-  // is 0.
-  for (int32_t i = 0; i < vertices_size; ++i) {
-    vertices_.push_back(glm::vec3(raw_vertices[i].x, raw_vertices[i].y, 0.0f));
+void PlaneRenderer::ReleaseUnusedMeshes() {
+  for (auto it = meshes_.begin(); it != meshes_.end();) {
+    if (it->second.last_used_frame != frame_) {
+      it = meshes_.erase(it);
+    } else {
+      ++it;
+    }
   }
+  frame_++;
+}
 
-  util::ScopedArPose scopedArPose(&ar_session);
-  ArPlane_getCenterPose(&ar_session, &ar_plane, scopedArPose.GetArPose());
-  ArPose_getMatrix(&ar_session, scopedArPose.GetArPose(),
-                   glm::value_ptr(model_mat_));
-  normal_vec_ = util::GetPlaneNormal(ar_session, *scopedArPose.GetArPose());
-
+void PlaneRenderer::BuildMesh(PlaneMesh* mesh) const {
   // Feather distance 0.2 meters.
   const float kFeatherLength = 0.2f;
   // Feather scale over the distance between plane center and vertices.
   const float kFeatherScale = 0.2f;
 
-  // Fill vertex 4 to 7, with alpha set to 1.
-  for (int32_t i = 0; i < vertices_size; ++i) {
-    // Vector from plane center to current point.
-    glm::vec2 v = raw_vertices[i];
-    const float scale =
-        1.0f - std::min((kFeatherLength / glm::length(v)), kFeatherScale);
-    const glm::vec2 result_v = scale * v;
-
-    vertices_.push_back(glm::vec3(result_v.x, result_v.y, 1.0f));
-  }
-
-  const int32_t vertices_length = vertices_.size();
-  const int32_t half_vertices_length = vertices_length / 2;
-
-  // Generate triangle (4, 5, 6) and (4, 6, 7).
-  for (int i = half_vertices_length + 1; i < vertices_length - 1; ++i) {
-    triangles_.push_back(half_vertices_length);
-    triangles_.push_back(i);
-    triangles_.push_back(i + 1);
-  }
-
-  // Generate triangle (0, 1, 4), (4, 1, 5), (5, 1, 2), (5, 2, 6),
-  // (6, 2, 3), (6, 3, 7), (7, 3, 0), (7, 0, 4)
-  for (int i = 0; i < half_vertices_length; ++i) {
-    triangles_.push_back(i);
-    triangles_.push_back((i + 1) % half_vertices_length);
-    triangles_.push_back(i + half_vertices_length);
-
-    triangles_.push_back(i + half_vertices_length);
-    triangles_.push_back((i + 1) % half_vertices_length);
-    triangles_.push_back((i + half_vertices_length + 1) % half_vertices_length +
-                         half_vertices_length);
-  }
+  // Sized in place, so a cached mesh only allocates when its polygon grows.
+  const int32_t polygon_size = raw_vertices_.size();
+  mesh->vertices.resize(FeatheredVertexCount(polygon_size));
+  mesh->triangles.resize(FeatheredIndexCount(polygon_size));
+  BuildFeatheredMesh(raw_vertices_.data(), polygon_size, kFeatherLength,
+                     kFeatherScale, mesh->vertices.data(),
+                     mesh->triangles.data());
 }
 
 }  // namespace hello_ar
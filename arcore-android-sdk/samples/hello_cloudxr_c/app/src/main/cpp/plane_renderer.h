@@ -23,14 +23,20 @@
 #include <array>
 #include <cstdint>
 #include <cstdlib>
+#include <unordered_map>
 #include <vector>
 
 #include "arcore_c_api.h"
 #include "glm.h"
+#include "plane_batch.h"
 
 namespace hello_ar {
 
 // PlaneRenderer renders ARCore plane type.
+//
+// Planes added during a frame are packed into one vertex buffer and drawn
+// with a single call.  Each plane's triangulated mesh is cached, and only
+// rebuilt when ARCore changes the plane's polygon.
 class PlaneRenderer {
  public:
   PlaneRenderer() = default;
@@ -40,27 +46,52 @@ class PlaneRenderer {
   // OpenGL thread.
   void InitializeGlContent(AAssetManager* asset_manager);
 
-  // Draws the provided plane.
+  // Adds the provided plane to the next Draw().
+  //
+  // @param scratch_pose, pose to read the plane center pose into.
+  void AddPlane(const ArSession& ar_session, const ArPlane& ar_plane,
+                ArPose* scratch_pose);
+
+  // Draws all planes added since the last call, in one draw call.
   void Draw(const glm::mat4& projection_mat, const glm::mat4& view_mat,
-            const ArSession& ar_session, const ArPlane& ar_plane,
             const glm::vec3& color);
 
+  // Frees the meshes of planes not added since the last call, such as
+  // subsumed or no longer tracked ones.  Call once per frame, after drawing.
+  void ReleaseUnusedMeshes();
+
  private:
-  void UpdateForPlane(const ArSession& ar_session, const ArPlane& ar_plane);
+  struct PlaneMesh {
+    // Feathered polygon in the plane's space, see BuildFeatheredMesh().
+    std::vector<glm::vec3> vertices;
+    std::vector<uint16_t> triangles;
+    // Identifies the polygon the mesh was built from.
+    int32_t polygon_length = 0;
+    uint64_t polygon_hash = 0;
+    uint32_t last_used_frame = 0;
+  };
+
+  void BuildMesh(PlaneMesh* mesh) const;
+
+  // Keyed by plane handle.  The polygon hash catches a handle that comes
+  // back for a different plane.
+  std::unordered_map<const ArPlane*, PlaneMesh> meshes_;
+  uint32_t frame_ = 0;
 
-  std::vector<glm::vec3> vertices_;
-  std::vector<GLushort> triangles_;
-  glm::mat4 model_mat_ = glm::mat4(1.0f);
-  glm::vec3 normal_vec_ = glm::vec3(0.0f);
+  // kept between planes and frames, so their storage is reused.
+  std::vector<glm::vec2> raw_vertices_;
+  PlaneBatch batch_;
 
   GLuint texture_id_;
+  GLuint vertex_buffer_ = 0;
+  GLuint index_buffer_ = 0;
 
   GLuint shader_program_;
-  GLint attri_vertices_;
-  GLint uniform_mvp_mat_;
+  GLint attri_position_;
+  GLint attri_alpha_;
+  GLint attri_normal_;
+  GLint uniform_view_projection_mat_;
   GLint uniform_texture_;
-  GLint uniform_model_mat_;
-  GLint uniform_normal_vec_;
   GLint uniform_color_;
 };
 }  // namespace hello_ar
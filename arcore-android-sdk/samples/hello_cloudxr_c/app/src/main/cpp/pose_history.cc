@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pose_history.h"
+
+namespace hello_ar {
+
+uint64_t PoseHistory::Push(const cxrMatrix34& pose, uint64_t camera_frame) {
+  const uint64_t pose_id = next_pose_id_++;
+
+  Entry& entry = entries_[pose_id % kCapacity];
+
+  // An odd sequence marks the slot as being written.
+  const uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+  entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  entry.pose_id.store(pose_id, std::memory_order_relaxed);
+  entry.camera_frame.store(camera_frame, std::memory_order_relaxed);
+  for (int i = 0; i < kMatrixElements; ++i) {
+    entry.pose[i].store(pose.m[i / 4][i % 4], std::memory_order_relaxed);
+  }
+
+  entry.sequence.store(sequence + 2, std::memory_order_release);
+  latest_pose_id_.store(pose_id, std::memory_order_release);
+
+  return pose_id;
+}
+
+uint64_t PoseHistory::GetLatest(cxrMatrix34* out_pose) const {
+  for (;;) {
+    const uint64_t pose_id = latest_pose_id_.load(std::memory_order_acquire);
+    if (pose_id == kInvalidPoseId) {
+      return kInvalidPoseId;
+    }
+
+    uint64_t camera_frame;
+    if (ReadEntry(pose_id, &camera_frame, out_pose)) {
+      return pose_id;
+    }
+    // The producer lapped the ring while we were reading, try the new latest.
+  }
+}
+
+bool PoseHistory::FindCameraFrame(uint64_t pose_id,
+                                  uint64_t* out_camera_frame) const {
+  if (pose_id == kInvalidPoseId) {
+    return false;
+  }
+
+  cxrMatrix34 pose;
+  return ReadEntry(pose_id, out_camera_frame, &pose);
+}
+
+bool PoseHistory::ReadEntry(uint64_t pose_id, uint64_t* out_camera_frame,
+                            cxrMatrix34* out_pose) const {
+  // Slots are addressed by ID, so an evicted pose shows up as an ID mismatch.
+  const Entry& entry = entries_[pose_id % kCapacity];
+
+  for (;;) {
+    const uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+    if (sequence & 1) {
+      continue;  // write in progress
+    }
+
+    const uint64_t entry_pose_id =
+        entry.pose_id.load(std::memory_order_relaxed);
+    const uint64_t camera_frame =
+        entry.camera_frame.load(std::memory_order_relaxed);
+    cxrMatrix34 pose;
+    for (int i = 0; i < kMatrixElements; ++i) {
+      pose.m[i / 4][i % 4] = entry.pose[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;  // torn read, try again
+    }
+
+    if (entry_pose_id != pose_id) {
+      return false;
+    }
+
+    *out_camera_frame = camera_frame;
+    *out_pose = pose;
+    return true;
+  }
+}
+
+}  // namespace hello_ar
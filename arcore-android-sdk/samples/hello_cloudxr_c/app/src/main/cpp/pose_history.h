@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_POSE_HISTORY_H_
+#define C_ARCORE_HELLO_AR_POSE_HISTORY_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "CloudXRCommon.h"
+
+namespace hello_ar {
+
+// Keeps the most recent poses sent to the server, each tagged with a
+// monotonically increasing pose ID and the camera frame it was sampled from.
+// The server echoes the pose ID back with every latched frame, so the camera
+// image matching a stream frame can be found in O(1) without comparing
+// matrices.
+//
+// The history is a single-producer ring: Push() must only be called from one
+// thread (the GL thread), while GetLatest() may be called from any other
+// thread (the CloudXR callback thread).  Each slot is guarded by a sequence
+// counter, so neither side ever blocks; a reader that races a write simply
+// retries.
+class PoseHistory {
+ public:
+  static constexpr int kCapacity = 16;
+
+  // Pose ID 0 is never assigned, and means "no pose".
+  static constexpr uint64_t kInvalidPoseId = 0;
+
+  PoseHistory() = default;
+  ~PoseHistory() = default;
+
+  // Records a pose along with the index of the camera frame it belongs to.
+  // Producer thread only.
+  // @return the pose ID assigned to this pose.
+  uint64_t Push(const cxrMatrix34& pose, uint64_t camera_frame);
+
+  // Copies the most recently pushed pose into out_pose.  Safe to call from
+  // any thread.
+  // @return its pose ID, or kInvalidPoseId if nothing was pushed yet.
+  uint64_t GetLatest(cxrMatrix34* out_pose) const;
+
+  // Looks up the camera frame recorded with pose_id.  Safe to call from any
+  // thread.
+  // @return false if the pose is unknown or has already been overwritten.
+  bool FindCameraFrame(uint64_t pose_id, uint64_t* out_camera_frame) const;
+
+  // Delete copy constructors.
+  PoseHistory(const PoseHistory&) = delete;
+  void operator=(const PoseHistory&) = delete;
+
+ private:
+  static constexpr int kMatrixElements = 12;
+
+  // The payload is stored as relaxed atomics so that a read racing a write is
+  // well defined; the sequence counter tells the reader to discard it.
+  struct Entry {
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint64_t> pose_id{kInvalidPoseId};
+    std::atomic<uint64_t> camera_frame{0};
+    std::array<std::atomic<float>, kMatrixElements> pose;
+  };
+
+  // Reads a consistent copy of the slot holding pose_id.
+  // @return false if the slot no longer holds pose_id.
+  bool ReadEntry(uint64_t pose_id, uint64_t* out_camera_frame,
+                 cxrMatrix34* out_pose) const;
+
+  std::array<Entry, kCapacity> entries_;
+  std::atomic<uint64_t> latest_pose_id_{kInvalidPoseId};
+
+  // Only touched by the producer thread.
+  uint64_t next_pose_id_ = kInvalidPoseId + 1;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_POSE_HISTORY_H_
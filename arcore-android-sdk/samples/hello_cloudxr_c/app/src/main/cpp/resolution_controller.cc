@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "resolution_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CloudXRLog.h"
+
+namespace hello_ar {
+namespace {
+// Stream resolution as a factor of the display, lowest first.
+constexpr float kLadder[] = {0.5f, 0.625f, 0.75f, 0.875f, 1.0f};
+constexpr int kLadderSteps = sizeof(kLadder) / sizeof(kLadder[0]);
+}  // namespace
+
+void ResolutionController::Reset(float factor, float stream_fps,
+                                 uint32_t max_bitrate_kbps) {
+  step_ = 0;
+  for (int step = 1; step < kLadderSteps; step++) {
+    if (std::fabs(kLadder[step] - factor) < std::fabs(kLadder[step_] - factor)) {
+      step_ = step;
+    }
+  }
+
+  down_votes_ = 0;
+  up_votes_ = 0;
+  cooldown_ = 0;
+  frame_budget_ms_ = 1000.0f / std::max(stream_fps, 1.0f);
+  bandwidth_kbps_ = 0.0f;
+  configured_bitrate_kbps_ = max_bitrate_kbps;
+  bitrate_kbps_ = max_bitrate_kbps;
+}
+
+float ResolutionController::GetFactor() const {
+  return kLadder[std::max(step_, 0)];
+}
+
+bool ResolutionController::Update(const cxrConnectionStats& stats) {
+  if (!IsInitialized() ||
+      stats.qualityReasons == cxrConnectionQualityReason_EstimatingQuality) {
+    return false;
+  }
+
+  if (stats.bandwidthAvailableKbps > 0) {
+    bandwidth_kbps_ = bandwidth_kbps_ == 0.0f ?
+        stats.bandwidthAvailableKbps :
+        bandwidth_kbps_ + kSmoothing * (stats.bandwidthAvailableKbps - bandwidth_kbps_);
+  }
+
+  if (cooldown_ > 0) {
+    cooldown_--;
+    return false;
+  }
+
+  const bool poor = IsPoor(stats);
+  down_votes_ = poor ? down_votes_ + 1 : 0;
+  up_votes_ = !poor && HasRoomToGrow(stats) ? up_votes_ + 1 : 0;
+
+  if (down_votes_ >= kDownSamples && step_ > 0) {
+    Change(step_ - 1);
+    return true;
+  }
+  if (up_votes_ >= kUpSamples && step_ < kLadderSteps - 1) {
+    Change(step_ + 1);
+    return true;
+  }
+  return false;
+}
+
+bool ResolutionController::IsPoor(const cxrConnectionStats& stats) const {
+  if (stats.quality <= cxrConnectionQuality_Poor) {
+    return true;
+  }
+
+  if (stats.quality == cxrConnectionQuality_Fair &&
+      (stats.qualityReasons & (cxrConnectionQualityReason_LowBandwidth |
+                               cxrConnectionQualityReason_HighPacketLoss))) {
+    return true;
+  }
+
+  // The decoder can't keep up at this size.
+  return stats.frameDeliveryTimeMs > kDecodeBudget * frame_budget_ms_;
+}
+
+bool ResolutionController::HasRoomToGrow(const cxrConnectionStats& stats) const {
+  if (stats.quality < cxrConnectionQuality_Good || step_ >= kLadderSteps - 1 ||
+      stats.frameDeliveryTimeMs > 0.5f * kDecodeBudget * frame_budget_ms_) {
+    return false;
+  }
+
+  // The next step costs roughly its extra pixels in bitrate.
+  const float ratio = kLadder[step_ + 1] / kLadder[step_];
+  const float needed_kbps = stats.bandwidthUtilizationKbps * ratio * ratio;
+  return needed_kbps < kBandwidthHeadroom * bandwidth_kbps_;
+}
+
+uint32_t ResolutionController::TargetBitrateKbps() const {
+  // Without a configured cap the server's own rate control is left alone.
+  if (configured_bitrate_kbps_ == 0 || bandwidth_kbps_ <= 0.0f) {
+    return configured_bitrate_kbps_;
+  }
+
+  const uint32_t sustainable_kbps =
+      static_cast<uint32_t>(kBandwidthHeadroom * bandwidth_kbps_);
+  return std::min(configured_bitrate_kbps_, sustainable_kbps);
+}
+
+void ResolutionController::Change(int step) {
+  const float old_factor = GetFactor();
+  step_ = step;
+  bitrate_kbps_ = TargetBitrateKbps();
+
+  down_votes_ = 0;
+  up_votes_ = 0;
+  cooldown_ = kCooldownSamples;
+
+  CXR_LOGI("Stream resolution factor %.3f -> %.3f, max bitrate %u kbps",
+           old_factor, GetFactor(), bitrate_kbps_);
+}
+
+}  // namespace hello_ar
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_RESOLUTION_CONTROLLER_H_
+#define C_ARCORE_HELLO_AR_RESOLUTION_CONTROLLER_H_
+
+#include <cstdint>
+
+#include "CloudXRClient.h"
+
+namespace hello_ar {
+
+// Picks the stream resolution, as a factor of the display resolution, and the
+// maximum bitrate from the connection stats, stepping along a fixed ladder.
+//
+// Every change costs a reconnect, so it steps down only after a few poor
+// samples in a row, up only after a long run of good ones, and waits a while
+// after each change before considering another.  The bitrate is only revised
+// along with a step, and never capped when no cap is configured.
+class ResolutionController {
+ public:
+  ResolutionController() = default;
+  ~ResolutionController() = default;
+
+  // Starts at the ladder step nearest factor.
+  // @param max_bitrate_kbps: configured bitrate cap, 0 for none.
+  void Reset(float factor, float stream_fps, uint32_t max_bitrate_kbps);
+
+  bool IsInitialized() const { return step_ >= 0; }
+
+  // Feeds one stats sample.
+  // @return true if GetFactor() or GetMaxBitrateKbps() changed, and the
+  //   stream should be renegotiated.
+  bool Update(const cxrConnectionStats& stats);
+
+  float GetFactor() const;
+
+  // @return the bitrate to ask for, 0 to leave it to the server.  Stays 0
+  //   when no cap is configured.
+  uint32_t GetMaxBitrateKbps() const { return bitrate_kbps_; }
+
+ private:
+  // Consecutive samples needed to step down, and to step up.
+  static constexpr int kDownSamples = 4;
+  static constexpr int kUpSamples = 20;
+  // Samples to wait after a change before voting again.
+  static constexpr int kCooldownSamples = 20;
+  // Share of the available bandwidth we aim to use.
+  static constexpr float kBandwidthHeadroom = 0.8f;
+  // Share of a frame interval decoding may take before we step down.
+  static constexpr float kDecodeBudget = 0.8f;
+  // Weight of the newest sample in the bandwidth average.
+  static constexpr float kSmoothing = 0.2f;
+
+  bool IsPoor(const cxrConnectionStats& stats) const;
+  bool HasRoomToGrow(const cxrConnectionStats& stats) const;
+  uint32_t TargetBitrateKbps() const;
+  void Change(int step);
+
+  int step_ = -1;
+  int down_votes_ = 0;
+  int up_votes_ = 0;
+  int cooldown_ = 0;
+
+  float frame_budget_ms_ = 1000.0f / 60.0f;
+  float bandwidth_kbps_ = 0.0f;
+  uint32_t configured_bitrate_kbps_ = 0;
+  uint32_t bitrate_kbps_ = 0;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_RESOLUTION_CONTROLLER_H_
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "stats_collector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "CloudXRLog.h"
+
+namespace hello_ar {
+namespace {
+constexpr float kPercentiles[StatsCollector::kNumPercentiles] = {
+    0.50f, 0.95f, 0.99f,
+};
+
+constexpr const char* kMetricNames[StatsCollector::kNumMetrics] = {
+    "RTT (ms)", "Bitrate (kbps)", "FPS", "Packet loss (%)",
+};
+}  // namespace
+
+constexpr int StatsCollector::kCapacity;
+
+void StatsCollector::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  count_ = 0;
+  next_ = 0;
+  last_packets_received_ = 0;
+  last_packets_lost_ = 0;
+}
+
+void StatsCollector::AddSample(const cxrConnectionStats& stats) {
+  Sample sample;
+  sample.unix_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  sample.values[kRoundTripMs] = static_cast<float>(stats.roundTripDelayMs);
+  sample.values[kBandwidthKbps] =
+      static_cast<float>(stats.bandwidthUtilizationKbps);
+  sample.values[kFramesPerSecond] = stats.framesPerSecond;
+  sample.bandwidth_available_kbps = stats.bandwidthAvailableKbps;
+  sample.quality = static_cast<int>(stats.quality);
+
+  // Under the lock, as Reset() may run on another thread.
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Counters restart with a new connection.
+  const bool restarted = stats.totalPacketsReceived < last_packets_received_ ||
+      stats.totalPacketsLost < last_packets_lost_;
+  const uint32_t received = restarted ? stats.totalPacketsReceived :
+      stats.totalPacketsReceived - last_packets_received_;
+  const uint32_t lost = restarted ? stats.totalPacketsLost :
+      stats.totalPacketsLost - last_packets_lost_;
+  last_packets_received_ = stats.totalPacketsReceived;
+  last_packets_lost_ = stats.totalPacketsLost;
+  sample.values[kPacketLossPercent] =
+      (received + lost) > 0 ? 100.0f * lost / (received + lost) : 0.0f;
+
+  samples_[next_] = sample;
+  next_ = (next_ + 1) % kCapacity;
+  count_ = std::min(count_ + 1, kCapacity);
+}
+
+int StatsCollector::GetPercentiles(
+    float out[kNumMetrics * kNumPercentiles]) const {
+  // Copied out under the lock and ranked after, so AddSample() only ever
+  // waits for the copy.
+  std::array<std::array<float, kCapacity>, kNumMetrics> values;
+  int count;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    count = count_;
+    for (int i = 0; i < count; i++) {
+      for (int metric = 0; metric < kNumMetrics; metric++) {
+        values[metric][i] = samples_[i].values[metric];
+      }
+    }
+  }
+  if (count == 0) {
+    return 0;
+  }
+
+  for (int metric = 0; metric < kNumMetrics; metric++) {
+    float* begin = values[metric].data();
+    for (int p = 0; p < kNumPercentiles; p++) {
+      const int rank = std::min(count - 1,
+                                static_cast<int>(kPercentiles[p] * count));
+      std::nth_element(begin, begin + rank, begin + count);
+      out[metric * kNumPercentiles + p] = begin[rank];
+    }
+  }
+  return count;
+}
+
+void StatsCollector::LogReport() const {
+  float percentiles[kNumMetrics * kNumPercentiles];
+  const int count = GetPercentiles(percentiles);
+  if (count == 0) {
+    return;
+  }
+
+  for (int metric = 0; metric < kNumMetrics; metric++) {
+    const float* p = &percentiles[metric * kNumPercentiles];
+    CXR_LOGI("%s p50/p95/p99 over %d samples: %.1f / %.1f / %.1f",
+             kMetricNames[metric], count, p[0], p[1], p[2]);
+  }
+}
+
+bool StatsCollector::AppendCsv(const std::string& path) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (count_ == 0) {
+    return true;
+  }
+
+  FILE* file = fopen(path.c_str(), "a");
+  if (!file) {
+    CXR_LOGE("Could not open connection stats file %s", path.c_str());
+    return false;
+  }
+
+  fseek(file, 0, SEEK_END);
+  if (ftell(file) == 0) {
+    fputs("unix_time_ms,rtt_ms,bandwidth_kbps,fps,packet_loss_pct,"
+          "bandwidth_available_kbps,quality\n", file);
+  }
+
+  // Oldest first.
+  const int first = count_ < kCapacity ? 0 : next_;
+  for (int i = 0; i < count_; i++) {
+    const Sample& sample = samples_[(first + i) % kCapacity];
+    fprintf(file, "%lld,%.0f,%.0f,%.1f,%.2f,%u,%d\n",
+            static_cast<long long>(sample.unix_time_ms),
+            sample.values[kRoundTripMs], sample.values[kBandwidthKbps],
+            sample.values[kFramesPerSecond], sample.values[kPacketLossPercent],
+            sample.bandwidth_available_kbps, sample.quality);
+  }
+
+  fclose(file);
+  CXR_LOGI("Wrote %d connection stats samples to %s", count_, path.c_str());
+  return true;
+}
+
+}  // namespace hello_ar
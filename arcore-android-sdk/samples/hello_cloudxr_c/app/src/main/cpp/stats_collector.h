@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_STATS_COLLECTOR_H_
+#define C_ARCORE_HELLO_AR_STATS_COLLECTOR_H_
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "CloudXRClient.h"
+
+namespace hello_ar {
+
+// Keeps a time series of connection stats in a fixed-size ring, and derives
+// rolling percentiles from it.  Samples are added on the GL thread, while
+// percentiles may be read from any thread, e.g. over JNI.
+class StatsCollector {
+ public:
+  enum Metric {
+    kRoundTripMs,
+    kBandwidthKbps,
+    kFramesPerSecond,
+    kPacketLossPercent,
+    kNumMetrics
+  };
+
+  // p50, p95 and p99, in that order.
+  static constexpr int kNumPercentiles = 3;
+
+  // At two samples a second, five minutes of history.
+  static constexpr int kCapacity = 600;
+
+  StatsCollector() = default;
+  ~StatsCollector() = default;
+
+  // Drops all samples, e.g. once written out.
+  void Reset();
+
+  void AddSample(const cxrConnectionStats& stats);
+
+  // Fills out with kNumMetrics groups of kNumPercentiles values, metrics in
+  // Metric order.
+  // @return the number of samples they are taken over, 0 leaves out as is.
+  int GetPercentiles(float out[kNumMetrics * kNumPercentiles]) const;
+
+  // Logs the percentiles of each metric.
+  void LogReport() const;
+
+  // Appends all samples to a CSV file, writing a header if it is new.
+  // @return false if the file could not be written.
+  bool AppendCsv(const std::string& path) const;
+
+  // Delete copy constructors.
+  StatsCollector(const StatsCollector&) = delete;
+  void operator=(const StatsCollector&) = delete;
+
+ private:
+  struct Sample {
+    int64_t unix_time_ms;
+    float values[kNumMetrics];
+    uint32_t bandwidth_available_kbps;
+    int quality;
+  };
+
+  mutable std::mutex mutex_;
+  std::array<Sample, kCapacity> samples_;
+  int count_ = 0;
+  int next_ = 0;
+
+  // Packet counters are cumulative, loss is taken over each interval.  Zeroed
+  // by Reset(), so a new session's counters are taken from the start.
+  uint32_t last_packets_received_ = 0;
+  uint32_t last_packets_lost_ = 0;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_STATS_COLLECTOR_H_
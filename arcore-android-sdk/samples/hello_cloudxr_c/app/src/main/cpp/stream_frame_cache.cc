@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "stream_frame_cache.h"
+
+#include "util.h"
+
+namespace hello_ar {
+namespace {
+// Positions of the quad vertices in clip space (X, Y).
+const GLfloat kVertices[] = {
+    -1.0f, -1.0f, +1.0f, -1.0f, -1.0f, +1.0f, +1.0f, +1.0f,
+};
+constexpr int kNumVertices = 4;
+
+constexpr char kVertexShaderFilename[] = "shaders/stream_reproject.vert";
+constexpr char kFragmentShaderFilename[] = "shaders/stream_reproject.frag";
+}  // namespace
+
+void StreamFrameCache::InitializeGlContent(AAssetManager* asset_manager,
+                                           int width, int height) {
+  shader_program_ = util::CreateProgram(kVertexShaderFilename,
+                                        kFragmentShaderFilename, asset_manager);
+  if (!shader_program_) {
+    CXR_LOGE("Could not create program.");
+  }
+
+  uniform_reprojection_ =
+      glGetUniformLocation(shader_program_, "u_Reprojection");
+  glUseProgram(shader_program_);
+  glUniform1i(glGetUniformLocation(shader_program_, "sTexture"), 1);
+  glUseProgram(0);
+
+  glGenBuffers(1, &vertex_buffer_);
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(kVertices), kVertices, GL_STATIC_DRAW);
+
+  const GLint attribute_vertices =
+      glGetAttribLocation(shader_program_, "a_Position");
+  glGenVertexArrays(1, &vao_);
+  glBindVertexArray(vao_);
+  glEnableVertexAttribArray(attribute_vertices);
+  glVertexAttribPointer(attribute_vertices, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // A new GL context invalidates the texture we had.
+  texture_id_ = 0;
+  fbo_id_ = 0;
+  SetSize(width, height);
+
+  util::CheckGlError("StreamFrameCache::InitializeGlContent() error");
+}
+
+void StreamFrameCache::SetSize(int width, int height) {
+  if (width == width_ && height == height_ && texture_id_ != 0) {
+    return;
+  }
+
+  width_ = width;
+  height_ = height;
+  dirty_ = true;
+  valid_ = false;
+}
+
+void StreamFrameCache::Allocate() {
+  if (texture_id_ == 0) {
+    glGenTextures(1, &texture_id_);
+    glGenFramebuffers(1, &fbo_id_);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture_id_, 0);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    CXR_LOGE("Stream frame cache framebuffer is incomplete.");
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  CXR_LOGI("Stream frame cache: %dx%d (%d KB)", width_, height_,
+           width_ * height_ * 4 / 1024);
+  dirty_ = false;
+  util::CheckGlError("StreamFrameCache::Allocate() error");
+}
+
+void StreamFrameCache::BeginCapture() {
+  if (dirty_) {
+    Allocate();
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
+  glViewport(0, 0, width_, height_);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glDisable(GL_BLEND);
+  glDisable(GL_DEPTH_TEST);
+}
+
+void StreamFrameCache::EndCapture() {
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_BLEND);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  valid_ = true;
+}
+
+void StreamFrameCache::Draw(const glm::mat3& reprojection) const {
+  if (!valid_) {
+    return;
+  }
+
+  glUseProgram(shader_program_);
+  glDepthMask(GL_FALSE);
+  glUniformMatrix3fv(uniform_reprojection_, 1, GL_FALSE,
+                     glm::value_ptr(reprojection));
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  glBindVertexArray(vao_);
+
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, kNumVertices);
+
+  glBindVertexArray(0);
+  glUseProgram(0);
+  glDepthMask(GL_TRUE);
+  util::CheckGlError("StreamFrameCache::Draw() error");
+}
+
+glm::mat3 StreamFrameCache::RotationalReprojection(
+    const glm::mat4& projection, const glm::mat4& frame_pose,
+    const glm::mat4& current_pose) {
+  // The projection as a 3x3 map from view direction to clip (x, y, w), which
+  // is all a pure rotation needs.
+  const glm::mat3 intrinsics(
+      projection[0][0], projection[0][1], projection[0][3],
+      projection[1][0], projection[1][1], projection[1][3],
+      projection[2][0], projection[2][1], projection[2][3]);
+
+  // Current view direction -> world -> the cached frame's view direction.
+  const glm::mat3 rotation =
+      glm::transpose(glm::mat3(frame_pose)) * glm::mat3(current_pose);
+
+  return intrinsics * rotation * glm::inverse(intrinsics);
+}
+
+}  // namespace hello_ar
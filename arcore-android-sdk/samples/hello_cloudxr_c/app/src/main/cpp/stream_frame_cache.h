@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_STREAM_FRAME_CACHE_H_
+#define C_ARCORE_HELLO_AR_STREAM_FRAME_CACHE_H_
+
+#include <GLES3/gl3.h>
+#include <android/asset_manager.h>
+
+#include "glm.h"
+
+namespace hello_ar {
+
+// Keeps a GPU copy of the last streamed frame, so it can be drawn again when
+// no new frame could be latched, instead of the overlay disappearing for a
+// display frame.  The copy can be drawn through a homography, to rotate it to
+// the current view.
+class StreamFrameCache {
+ public:
+  enum class HoldMode {
+    kOff,        // show nothing without a latched frame
+    kHold,       // show the cached frame as it was
+    kReproject,  // show the cached frame rotated to the current view
+  };
+
+  StreamFrameCache() = default;
+  ~StreamFrameCache() = default;
+
+  // Sets up OpenGL state.  Must be called on the OpenGL thread and before any
+  // other methods below.
+  void InitializeGlContent(AAssetManager* asset_manager, int width, int height);
+
+  // Resizes the cache to the display, which drops the cached frame.
+  void SetSize(int width, int height);
+
+  // Redirects rendering into the cache until EndCapture(), so the streamed
+  // frame can be blitted into it.  Blending is off while capturing, so the
+  // cache holds the stream's own alpha.
+  void BeginCapture();
+  void EndCapture();
+
+  bool IsValid() const { return valid_; }
+  void Invalidate() { valid_ = false; }
+
+  // Blends the cached frame over the current framebuffer.
+  // @param reprojection maps the destination's normalized device coordinates
+  //   to those of the cached frame.  Identity draws it as it was.
+  void Draw(const glm::mat3& reprojection) const;
+
+  // Builds the homography that rotates a frame rendered from frame_pose to
+  // current_pose, with both views using projection.  Poses are camera to
+  // world, translation is ignored.
+  static glm::mat3 RotationalReprojection(const glm::mat4& projection,
+                                          const glm::mat4& frame_pose,
+                                          const glm::mat4& current_pose);
+
+ private:
+  void Allocate();
+
+  int width_ = 1;
+  int height_ = 1;
+  bool dirty_ = true;
+  bool valid_ = false;
+
+  GLuint texture_id_ = 0;
+  GLuint fbo_id_ = 0;
+
+  GLuint shader_program_ = 0;
+  GLuint vertex_buffer_ = 0;
+  GLuint vao_ = 0;
+  GLint uniform_reprojection_ = -1;
+};
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_STREAM_FRAME_CACHE_H_
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "trace.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util.h"
+
+namespace hello_ar {
+namespace trace {
+namespace {
+// Per thread; at a few hundred events a second this covers several drains.
+constexpr uint32_t kRingSize = 4096;
+// Threads that can record at once.  Events from any more are dropped.
+constexpr int kMaxThreads = 16;
+constexpr int kDrainIntervalMs = 500;
+
+struct Event {
+  const char* name;
+  int64_t start_us;
+  int64_t duration_us;
+};
+
+// A slot is claimed by a recording thread, released when that thread exits,
+// and freed for reuse by the writer once it has drained what is left.
+enum class SlotState : uint32_t { kFree, kOwned, kReleased };
+
+// Single producer (the owning thread), single consumer (the writer thread).
+struct ThreadBuffer {
+  std::atomic<SlotState> state{SlotState::kFree};
+  int tid = 0;  // set by the owner before its first event
+  std::array<Event, kRingSize> events;
+  std::atomic<uint32_t> head{0};  // next slot to write, owned by the producer
+  std::atomic<uint32_t> tail{0};  // next slot to read, owned by the consumer
+  std::atomic<uint32_t> dropped{0};
+};
+
+// An event moved out of a ring, to be written without holding g_mutex.
+struct PendingEvent {
+  Event event;
+  int tid;
+};
+
+std::atomic<bool> g_running{false};
+
+// Allocated up front, so recording never allocates or locks.
+ThreadBuffer g_buffers[kMaxThreads];
+// Events from threads that found every slot taken.
+std::atomic<uint32_t> g_unclaimed_dropped{0};
+
+// Guards draining the rings.  Never taken while recording.
+std::mutex g_mutex;
+std::condition_variable g_wake;
+// Only written by the writer thread, or by Start() and Stop() while there is
+// none.
+FILE* g_file = nullptr;
+bool g_first_event = true;
+std::thread g_writer;
+
+// Releases the thread's slot when the thread exits.
+struct ThreadSlot {
+  ThreadBuffer* buffer = nullptr;
+
+  ~ThreadSlot() {
+    if (buffer) {
+      buffer->state.store(SlotState::kReleased, std::memory_order_release);
+    }
+  }
+};
+
+thread_local ThreadSlot t_slot;
+
+// @return the thread's buffer, or nullptr if all slots are taken.
+ThreadBuffer* GetThreadBuffer() {
+  if (!t_slot.buffer) {
+    for (ThreadBuffer& buffer : g_buffers) {
+      SlotState expected = SlotState::kFree;
+      if (buffer.state.compare_exchange_strong(expected, SlotState::kOwned,
+                                               std::memory_order_acquire)) {
+        buffer.tid = static_cast<int>(gettid());
+        t_slot.buffer = &buffer;
+        break;
+      }
+    }
+  }
+  return t_slot.buffer;
+}
+
+// Moves the recorded events into pending, and frees the slots of exited
+// threads once they are empty.  Caller holds g_mutex.
+// @return the number of events dropped since the last call.
+uint32_t CollectLocked(std::vector<PendingEvent>* pending) {
+  uint32_t dropped = g_unclaimed_dropped.exchange(0);
+  for (ThreadBuffer& buffer : g_buffers) {
+    // Read before head, so a released slot's last event is seen below.
+    const SlotState state = buffer.state.load(std::memory_order_acquire);
+    if (state == SlotState::kFree) {
+      continue;
+    }
+
+    uint32_t tail = buffer.tail.load(std::memory_order_relaxed);
+    const uint32_t head = buffer.head.load(std::memory_order_acquire);
+    for (; tail != head; tail++) {
+      pending->push_back({buffer.events[tail % kRingSize], buffer.tid});
+    }
+    buffer.tail.store(tail, std::memory_order_release);
+    dropped += buffer.dropped.exchange(0);
+
+    if (state == SlotState::kReleased) {
+      buffer.state.store(SlotState::kFree, std::memory_order_release);
+    }
+  }
+  return dropped;
+}
+
+// Only called by the writer thread, or by Stop() once it has joined it.
+void Write(const std::vector<PendingEvent>& pending, uint32_t dropped) {
+  const int pid = static_cast<int>(getpid());
+  for (const PendingEvent& pending_event : pending) {
+    const Event& event = pending_event.event;
+    fprintf(g_file,
+            "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,"
+            "\"pid\":%d,\"tid\":%d}",
+            g_first_event ? "" : ",", event.name,
+            static_cast<long long>(event.start_us),
+            static_cast<long long>(event.duration_us), pid, pending_event.tid);
+    g_first_event = false;
+  }
+  fflush(g_file);
+
+  if (dropped > 0) {
+    CXR_LOGE("Trace dropped %u events", dropped);
+  }
+}
+
+void WriterLoop() {
+  std::vector<PendingEvent> pending;
+  pending.reserve(kRingSize);
+
+  std::unique_lock<std::mutex> lock(g_mutex);
+  while (g_running) {
+    g_wake.wait_for(lock, std::chrono::milliseconds(kDrainIntervalMs));
+    const uint32_t dropped = CollectLocked(&pending);
+
+    lock.unlock();
+    Write(pending, dropped);
+    pending.clear();
+    lock.lock();
+  }
+}
+}  // namespace
+
+bool Start(const std::string& path) {
+  if (g_running) {
+    return true;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_file = fopen(path.c_str(), "w");
+    if (!g_file) {
+      CXR_LOGE("Could not open trace file %s", path.c_str());
+      return false;
+    }
+    fputs("[", g_file);
+    g_first_event = true;
+  }
+
+  CXR_LOGI("Tracing to %s", path.c_str());
+  g_running = true;
+  g_writer = std::thread(WriterLoop);
+  return true;
+}
+
+void Stop() {
+  if (!g_running.exchange(false)) {
+    return;
+  }
+
+  g_wake.notify_all();
+  g_writer.join();
+
+  std::vector<PendingEvent> pending;
+  uint32_t dropped;
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    dropped = CollectLocked(&pending);
+  }
+  Write(pending, dropped);
+  fputs("\n]\n", g_file);
+  fclose(g_file);
+  g_file = nullptr;
+}
+
+bool IsRunning() {
+  return g_running.load(std::memory_order_relaxed);
+}
+
+void Record(const char* name, int64_t start_us, int64_t end_us) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  if (!buffer) {
+    g_unclaimed_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  const uint32_t head = buffer->head.load(std::memory_order_relaxed);
+  if (head - buffer->tail.load(std::memory_order_acquire) >= kRingSize) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  buffer->events[head % kRingSize] = {name, start_us, end_us - start_us};
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+Scope::Scope(const char* name)
+    : name_(name), start_us_(IsRunning() ? util::NowUs() : 0) {}
+
+Scope::~Scope() {
+  if (start_us_ != 0) {
+    Record(name_, start_us_, util::NowUs());
+  }
+}
+
+}  // namespace trace
+}  // namespace hello_ar
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef C_ARCORE_HELLO_AR_TRACE_H_
+#define C_ARCORE_HELLO_AR_TRACE_H_
+
+#include <cstdint>
+#include <string>
+
+// Records the duration of the enclosing scope under name, a string literal,
+// when tracing is running.  Otherwise costs one atomic load.
+#define TRACE_SCOPE(name) \
+  hello_ar::trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_CONCAT_INNER(a, b) a##b
+
+namespace hello_ar {
+
+// Lightweight tracing of scopes across threads, written as a Chrome trace
+// (JSON array format) that loads in chrome://tracing and Perfetto.
+//
+// Each thread records into its own ring buffer, taken from a fixed pool on its
+// first event and returned when it exits, with no locks or allocation.  A
+// background thread drains the rings into the file, so recording never waits
+// on I/O.  A ring that fills up faster than it is drained drops events, as do
+// threads that find the pool empty, and the drops are logged.
+namespace trace {
+
+// Starts tracing to path, replacing any existing file.
+// @return false if the file could not be opened.
+bool Start(const std::string& path);
+
+// Writes out what is left and closes the file.
+void Stop();
+
+bool IsRunning();
+
+// Records a finished scope, times from util::NowUs().  name must be a string
+// literal, or otherwise outlive the trace.
+void Record(const char* name, int64_t start_us, int64_t end_us);
+
+class Scope {
+ public:
+  explicit Scope(const char* name);
+  ~Scope();
+
+  // Delete copy constructors.
+  Scope(const Scope&) = delete;
+  void operator=(const Scope&) = delete;
+
+ private:
+  const char* name_;
+  const int64_t start_us_;
+};
+
+}  // namespace trace
+}  // namespace hello_ar
+
+#endif  // C_ARCORE_HELLO_AR_TRACE_H_
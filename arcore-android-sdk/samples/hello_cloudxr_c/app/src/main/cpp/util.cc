@@ -16,11 +16,35 @@
 #include "util.h"
 
 #include <unistd.h>
+#include <chrono>
 #include <sstream>
 #include <string>
 
 #include "jni_interface.h"
 
+#if HELLO_AR_COUNT_ALLOCATIONS
+namespace {
+thread_local uint64_t thread_allocations = 0;
+}  // namespace
+
+// Replaces the global allocation functions, to count every new.  The other
+// forms of new and delete forward to these.
+void* operator new(size_t size) {
+  thread_allocations++;
+  void* p = malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    abort();
+  }
+  return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete[](void* p) noexcept { free(p); }
+#endif  // HELLO_AR_COUNT_ALLOCATIONS
+
 namespace hello_ar {
 namespace util {
 
@@ -392,6 +416,19 @@ bool LoadObjFile(const std::string& file_name, AAssetManager* asset_manager,
   return true;
 }
 
+int64_t NowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t GetThreadAllocationCount() {
+#if HELLO_AR_COUNT_ALLOCATIONS
+  return thread_allocations;
+#else
+  return 0;
+#endif
+}
+
 void Log4x4Matrix(const float raw_matrix[16]) {
   CXR_LOGI(
       "%f, %f, %f, %f\n"
@@ -406,15 +443,14 @@ void Log4x4Matrix(const float raw_matrix[16]) {
 
 void GetTransformMatrixFromAnchor(const ArAnchor& ar_anchor,
                                   ArSession* ar_session,
+                                  ArPose* scratch_pose,
                                   glm::mat4* out_model_mat) {
   if (out_model_mat == nullptr) {
     CXR_LOGE("util::GetTransformMatrixFromAnchor model_mat is null.");
     return;
   }
-  util::ScopedArPose pose(ar_session);
-  ArAnchor_getPose(ar_session, &ar_anchor, pose.GetArPose());
-  ArPose_getMatrix(ar_session, pose.GetArPose(),
-                   glm::value_ptr(*out_model_mat));
+  ArAnchor_getPose(ar_session, &ar_anchor, scratch_pose);
+  ArPose_getMatrix(ar_session, scratch_pose, glm::value_ptr(*out_model_mat));
 }
 
 glm::vec3 GetPlaneNormal(const ArSession& ar_session,
@@ -66,6 +66,90 @@ class ScopedArPose {
   ArPose* pose_;
 };
 
+// Provides a scoped allocated instance of ArLightEstimate.
+class ScopedArLightEstimate {
+ public:
+  explicit ScopedArLightEstimate(const ArSession* session) {
+    ArLightEstimate_create(session, &light_estimate_);
+  }
+  ~ScopedArLightEstimate() { ArLightEstimate_destroy(light_estimate_); }
+  ArLightEstimate* GetArLightEstimate() { return light_estimate_; }
+  // Delete copy constructors.
+  ScopedArLightEstimate(const ScopedArLightEstimate&) = delete;
+  void operator=(const ScopedArLightEstimate&) = delete;
+
+ private:
+  ArLightEstimate* light_estimate_;
+};
+
+// Provides a scoped allocated instance of ArTrackableList.
+class ScopedArTrackableList {
+ public:
+  explicit ScopedArTrackableList(const ArSession* session) {
+    ArTrackableList_create(session, &trackable_list_);
+  }
+  ~ScopedArTrackableList() { ArTrackableList_destroy(trackable_list_); }
+  ArTrackableList* GetArTrackableList() { return trackable_list_; }
+  // Delete copy constructors.
+  ScopedArTrackableList(const ScopedArTrackableList&) = delete;
+  void operator=(const ScopedArTrackableList&) = delete;
+
+ private:
+  ArTrackableList* trackable_list_;
+};
+
+// Provides a scoped allocated instance of ArHitResultList.
+class ScopedArHitResultList {
+ public:
+  explicit ScopedArHitResultList(const ArSession* session) {
+    ArHitResultList_create(session, &hit_result_list_);
+  }
+  ~ScopedArHitResultList() { ArHitResultList_destroy(hit_result_list_); }
+  ArHitResultList* GetArHitResultList() { return hit_result_list_; }
+  // Delete copy constructors.
+  ScopedArHitResultList(const ScopedArHitResultList&) = delete;
+  void operator=(const ScopedArHitResultList&) = delete;
+
+ private:
+  ArHitResultList* hit_result_list_;
+};
+
+// Provides a scoped allocated instance of ArHitResult.
+class ScopedArHitResult {
+ public:
+  explicit ScopedArHitResult(const ArSession* session) {
+    ArHitResult_create(session, &hit_result_);
+  }
+  ~ScopedArHitResult() { ArHitResult_destroy(hit_result_); }
+  ArHitResult* GetArHitResult() { return hit_result_; }
+  // Delete copy constructors.
+  ScopedArHitResult(const ScopedArHitResult&) = delete;
+  void operator=(const ScopedArHitResult&) = delete;
+
+ private:
+  ArHitResult* hit_result_;
+};
+
+// ARCore objects reused every frame, instead of being created and destroyed
+// each time they are needed.  Create once the session exists, and destroy
+// before the session.
+struct ArObjectPool {
+  explicit ArObjectPool(const ArSession* session)
+      : pose(session),
+        light_estimate(session),
+        plane_list(session),
+        image_list(session),
+        hit_result_list(session),
+        hit_result(session) {}
+
+  ScopedArPose pose;
+  ScopedArLightEstimate light_estimate;
+  ScopedArTrackableList plane_list;
+  ScopedArTrackableList image_list;
+  ScopedArHitResultList hit_result_list;
+  ScopedArHitResult hit_result;
+};
+
 // Check GL error, and abort if an error is encountered.
 //
 // @param operation, the name of the GL function call.
@@ -115,13 +199,23 @@ bool LoadObjFile(const std::string& file_name, AAssetManager* asset_manager,
                  std::vector<GLfloat>* out_uv,
                  std::vector<GLushort>* out_indices);
 
+// Monotonic time in microseconds, for measuring intervals.
+int64_t NowUs();
+
+// Number of operator new calls made so far by the calling thread.  Only
+// counted when built with HELLO_AR_COUNT_ALLOCATIONS, otherwise always 0.
+uint64_t GetThreadAllocationCount();
+
 // Format and output the matrix to logcat file.
 // Note that this function output matrix in row major.
 void Log4x4Matrix(const float raw_matrix[16]);
 
 // Get transformation matrix from ArAnchor.
+//
+// @param scratch_pose, pose to read the anchor pose into.
 void GetTransformMatrixFromAnchor(const ArAnchor& ar_anchor,
                                   ArSession* ar_session,
+                                  ArPose* scratch_pose,
                                   glm::mat4* out_model_mat);
 
 // Get the plane's normal from center pose.
@@ -66,6 +66,12 @@ public class JniInterface {
   public static native void setArgs(long nativeApplication, String jargs);
   public static native String getServerIp(long nativeApplication);
 
+  /**
+   * Rolling connection stats: p50, p95 and p99 of round trip time (ms), bitrate (kbps), FPS and
+   * packet loss (%), in that order. Empty until the first stats arrive. Callable from any thread.
+   */
+  public static native float[] getConnectionStats(long nativeApplication);
+
   public static native void onResume(long nativeApplication, Context context, Activity activity);
 
   /** Allocate OpenGL resources for rendering. */
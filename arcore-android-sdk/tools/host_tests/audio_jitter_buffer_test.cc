@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Drives AudioJitterBuffer with synthetic server audio: 10 ms packets of a
+// tone, sent on the server's clock and delayed by a scripted network, while
+// the device pulls 5 ms bursts on its own clock.  Events are simulated in
+// time order on one thread, so every run is repeatable; a last test runs the
+// two sides on real threads.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "audio_jitter_buffer.h"
+#include "test_util.h"
+
+namespace {
+
+using hello_ar::AudioJitterBuffer;
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int kChannels = AudioJitterBuffer::kChannels;
+constexpr int32_t kPacketFrames = kSampleRate / 100;  // 10 ms
+constexpr int32_t kBurstFrames = kSampleRate / 200;   // 5 ms
+constexpr double kToneHz = 440.0;
+constexpr double kToneAmplitude = 8000.0;
+
+double FramesToMs(int32_t frames) { return frames * 1000.0 / kSampleRate; }
+
+// Network delay of packet k, in microseconds.
+using DelayFn = std::function<int64_t(int k)>;
+
+struct Run {
+  std::vector<int16_t> output;  // interleaved, as played
+  // Sampled after every device burst.
+  std::vector<AudioJitterBuffer::Stats> stats;
+};
+
+// Plays duration_ms of device time.  The server's clock runs server_rate
+// times as fast as the device's.  Packets arrive in order.
+Run Simulate(int duration_ms, double server_rate, const DelayFn& delay) {
+  // The ring is too big for the stack.
+  std::unique_ptr<AudioJitterBuffer> buffer(new AudioJitterBuffer());
+  buffer->Reset(kSampleRate);
+
+  Run run;
+  const int64_t end_us = duration_ms * 1000LL;
+  const double packet_us = 10000.0 / server_rate;
+  const int64_t burst_us = 5000;
+
+  std::vector<int16_t> packet(kPacketFrames * kChannels);
+  std::vector<int16_t> burst(kBurstFrames * kChannels);
+  int64_t tone_frame = 0;
+  int k = 0;
+  int64_t last_arrival_us = 0;
+  int64_t next_arrival_us = delay(0);
+  int64_t next_read_us = 0;
+
+  while (std::min(next_arrival_us, next_read_us) < end_us) {
+    if (next_arrival_us <= next_read_us) {
+      for (int32_t i = 0; i < kPacketFrames; ++i, ++tone_frame) {
+        const double t = static_cast<double>(tone_frame) / kSampleRate;
+        const int16_t value = static_cast<int16_t>(
+            std::lround(kToneAmplitude * std::sin(2.0 * M_PI * kToneHz * t)));
+        for (int ch = 0; ch < kChannels; ++ch) {
+          packet[i * kChannels + ch] = value;
+        }
+      }
+      buffer->Write(packet.data(), kPacketFrames);
+
+      ++k;
+      last_arrival_us = next_arrival_us;
+      next_arrival_us = std::max(
+          last_arrival_us,
+          static_cast<int64_t>(std::llround(k * packet_us)) + delay(k));
+    } else {
+      buffer->Read(burst.data(), kBurstFrames);
+      run.output.insert(run.output.end(), burst.begin(), burst.end());
+      run.stats.push_back(buffer->GetStats());
+      next_read_us += burst_us;
+    }
+  }
+
+  return run;
+}
+
+// Largest step between neighboring output samples.  A clean 440 Hz tone
+// steps by at most about 460; a cut to or from silence jumps by thousands.
+int MaxStep(const Run& run, size_t begin_frame, size_t end_frame) {
+  int max_step = 0;
+  end_frame = std::min(end_frame, run.output.size() / kChannels);
+  for (size_t i = std::max<size_t>(begin_frame, 1); i < end_frame; ++i) {
+    const int step =
+        std::abs(run.output[i * kChannels] - run.output[(i - 1) * kChannels]);
+    max_step = std::max(max_step, step);
+  }
+  return max_step;
+}
+
+int Peak(const Run& run, size_t begin_frame, size_t end_frame) {
+  int peak = 0;
+  end_frame = std::min(end_frame, run.output.size() / kChannels);
+  for (size_t i = begin_frame; i < end_frame; ++i) {
+    peak = std::max(peak, std::abs(static_cast<int>(run.output[i * kChannels])));
+  }
+  return peak;
+}
+
+size_t BurstAtMs(int ms) { return ms / 5; }
+size_t FrameAtMs(int ms) { return static_cast<size_t>(ms) * kSampleRate / 1000; }
+
+DelayFn Constant(int64_t delay_us) {
+  return [delay_us](int) { return delay_us; };
+}
+
+// Wi-Fi like jitter: 20 ms base delay plus up to 10 ms, and a spike of
+// 40-70 ms on one packet in fifty, which holds up the ones behind it.
+DelayFn Jittered(uint32_t seed) {
+  std::vector<int64_t> delays;
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int64_t> jitter(0, 10000);
+  std::uniform_int_distribution<int64_t> spike(40000, 70000);
+  for (int i = 0; i < 20000; ++i) {
+    delays.push_back(20000 + jitter(rng) + (i % 50 == 49 ? spike(rng) : 0));
+  }
+  return [delays](int k) { return delays[k % delays.size()]; };
+}
+
+void TestSteady() {
+  const Run run = Simulate(5000, 1.0, Constant(20000));
+  const AudioJitterBuffer::Stats& last = run.stats.back();
+  std::printf("steady: target %.1f ms, fill %.1f ms\n",
+              FramesToMs(last.target_frames), FramesToMs(last.fill_frames));
+
+  CHECK(last.underruns == 0);
+  CHECK(last.skipped_frames == 0);
+  CHECK(last.overflow_frames == 0);
+  // Plays the tone once buffered, without clicks.
+  CHECK(Peak(run, FrameAtMs(100), FrameAtMs(5000)) > 7900);
+  CHECK(MaxStep(run, FrameAtMs(100), FrameAtMs(5000)) < 600);
+}
+
+void TestUnderrunAndRebuffer() {
+  // Packets sent in the 150 ms from 2 s on are held up until 2.3 s.
+  const Run run = Simulate(6000, 1.0, [](int k) -> int64_t {
+    const int64_t sent_us = k * 10000LL;
+    if (sent_us >= 2000000 && sent_us < 2150000) {
+      return 2300000 - sent_us;
+    }
+    return 20000;
+  });
+
+  const AudioJitterBuffer::Stats before = run.stats[BurstAtMs(1990)];
+  const AudioJitterBuffer::Stats after = run.stats.back();
+  std::printf("underrun: target %.1f -> %.1f ms, %u underrun(s)\n",
+              FramesToMs(before.target_frames), FramesToMs(after.target_frames),
+              after.underruns);
+
+  CHECK(before.underruns == 0);
+  CHECK(after.underruns == 1);
+  // A dropout raises the target latency.
+  CHECK(after.target_frames > before.target_frames);
+  // The gap fades out and back in rather than clicking.
+  CHECK(MaxStep(run, FrameAtMs(100), FrameAtMs(6000)) < 600);
+  // Silent during the gap, then playing again.
+  CHECK(Peak(run, FrameAtMs(2150), FrameAtMs(2300)) == 0);
+  CHECK(Peak(run, FrameAtMs(2500), FrameAtMs(6000)) > 7900);
+}
+
+void TestSkipOnBurst() {
+  // A 500 ms stall, after which the queued packets all arrive at once.
+  const Run run = Simulate(6000, 1.0, [](int k) -> int64_t {
+    const int64_t sent_us = k * 10000LL;
+    if (sent_us >= 2000000 && sent_us < 2500000) {
+      return 2500000 - sent_us + 20000;
+    }
+    return 20000;
+  });
+
+  const AudioJitterBuffer::Stats after_burst = run.stats[BurstAtMs(2600)];
+  const AudioJitterBuffer::Stats last = run.stats.back();
+  std::printf("burst: skipped %.1f ms, fill %.1f ms after the burst\n",
+              FramesToMs(last.skipped_frames),
+              FramesToMs(after_burst.fill_frames));
+
+  CHECK(last.skipped_frames > 0);
+  CHECK(last.overflow_frames == 0);
+  // Back near the target instead of playing the whole burst late.
+  CHECK(after_burst.fill_frames <
+        after_burst.target_frames + static_cast<int32_t>(FrameAtMs(20)));
+}
+
+// The target grows under jitter, and shrinks back once arrival is steady.
+void TestAdaptsToJitter() {
+  const DelayFn jittered = Jittered(7);
+  const Run run = Simulate(40000, 1.0, [&](int k) -> int64_t {
+    return k < 1000 ? jittered(k) : 20000;
+  });
+
+  const AudioJitterBuffer::Stats jitter_end = run.stats[BurstAtMs(10000)];
+  const AudioJitterBuffer::Stats last = run.stats.back();
+  std::printf("jitter: target %.1f ms after 10 s of jitter, %.1f ms after "
+              "30 s steady, %u underrun(s)\n",
+              FramesToMs(jitter_end.target_frames),
+              FramesToMs(last.target_frames), last.underruns);
+
+  // Spikes beyond the initial 40 ms underrun, and grow the target.
+  CHECK(jitter_end.underruns > 0);
+  CHECK(jitter_end.target_frames > static_cast<int32_t>(FrameAtMs(40)));
+  CHECK(last.target_frames < jitter_end.target_frames);
+  // No more underruns once the target has grown to cover the jitter.
+  CHECK(run.stats[BurstAtMs(5000)].underruns == jitter_end.underruns);
+  CHECK(last.underruns == jitter_end.underruns);
+}
+
+// Average fill level relative to the target between two times.
+double MeanFillRatio(const Run& run, int begin_ms, int end_ms) {
+  double sum = 0.0;
+  const size_t end = std::min(BurstAtMs(end_ms), run.stats.size());
+  for (size_t i = BurstAtMs(begin_ms); i < end; ++i) {
+    sum += static_cast<double>(run.stats[i].fill_frames) /
+           run.stats[i].target_frames;
+  }
+  return sum / (end - BurstAtMs(begin_ms));
+}
+
+// A server clock running fast or slow must neither grow nor drain the
+// buffer: resampling settles the fill level at a steady offset from the
+// target.
+void TestDriftConverges(double server_rate) {
+  const Run run = Simulate(120000, server_rate, Constant(20000));
+
+  const double early = MeanFillRatio(run, 60000, 90000);
+  const double late = MeanFillRatio(run, 90000, 120000);
+  const AudioJitterBuffer::Stats& last = run.stats.back();
+  std::printf("drift %+.1f%%: target %.1f ms, fill %.2fx then %.2fx target, "
+              "%u underrun(s), skipped %u frames\n",
+              (server_rate - 1.0) * 100.0, FramesToMs(last.target_frames),
+              early, late, last.underruns, last.skipped_frames);
+
+  CHECK(last.underruns == 0);
+  CHECK(last.skipped_frames == 0);
+  CHECK(std::fabs(late - early) < 0.05);
+  CHECK(late > 0.5 && late < 1.5);
+}
+
+// Producer and consumer on real threads, to catch races under TSan.
+void TestThreads() {
+  std::unique_ptr<AudioJitterBuffer> buffer(new AudioJitterBuffer());
+  buffer->Reset(kSampleRate);
+  std::atomic<bool> done{false};
+
+  std::thread producer([&]() {
+    std::vector<int16_t> packet(kPacketFrames * kChannels, 1000);
+    for (int k = 0; k < 100; ++k) {
+      buffer->Write(packet.data(), kPacketFrames);
+      std::this_thread::sleep_for(std::chrono::milliseconds(k % 3 == 0 ? 15 : 8));
+    }
+    done = true;
+  });
+
+  std::vector<int16_t> burst(kBurstFrames * kChannels);
+  int peak = 0;
+  while (!done) {
+    buffer->Read(burst.data(), kBurstFrames);
+    for (int16_t sample : burst) peak = std::max<int>(peak, sample);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  producer.join();
+
+  CHECK(peak == 1000);
+}
+
+}  // namespace
+
+int main() {
+  TestSteady();
+  TestUnderrunAndRebuffer();
+  TestSkipOnBurst();
+  TestAdaptsToJitter();
+  TestDriftConverges(1.003);
+  TestDriftConverges(0.997);
+  TestThreads();
+  return host_tests::Result();
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Drives the ConnectionWorker state machine with a fake receiver, whose
+// create and connect outcomes are scripted per attempt.  Connect results are
+// delivered from a separate thread, as the CloudXR client reports them.
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "connection_worker.h"
+#include "test_util.h"
+
+namespace {
+
+using hello_ar::ConnectionWorker;
+using State = ConnectionWorker::State;
+
+// Outcome of a scripted connect.  kNever leaves the connection hanging.
+enum class Outcome { kConnect, kFail, kNever };
+
+class FakeReceiver {
+ public:
+  // Outcomes for the following attempts; once used up, attempts succeed.
+  void Script(std::vector<cxrError> create_errors,
+              std::vector<Outcome> connect_outcomes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    create_errors_.assign(create_errors.begin(), create_errors.end());
+    connect_outcomes_.assign(connect_outcomes.begin(), connect_outcomes.end());
+  }
+
+  ConnectionWorker::Steps MakeSteps() {
+    return {[this]() { ++prepares; },
+            [this]() { return Create(); },
+            [this]() { return Connect(); },
+            [this]() { Destroy(); }};
+  }
+
+  void set_worker(ConnectionWorker* worker) { worker_ = worker; }
+
+  // Waits for connect results still on their way.  Call only while the
+  // worker is stopped.
+  void JoinReporters() {
+    for (std::thread& thread : reporters_) thread.join();
+    reporters_.clear();
+  }
+
+  std::atomic<int> prepares{0};
+  std::atomic<int> creates{0};
+  std::atomic<int> connects{0};
+  std::atomic<int> destroys{0};
+  std::atomic<bool> alive{false};
+
+ private:
+  cxrError Create() {
+    ++creates;
+    cxrError err = cxrError_Success;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!create_errors_.empty()) {
+        err = create_errors_.front();
+        create_errors_.pop_front();
+      }
+    }
+    alive = err == cxrError_Success;
+    return err;
+  }
+
+  cxrError Connect() {
+    ++connects;
+    Outcome outcome = Outcome::kConnect;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!connect_outcomes_.empty()) {
+        outcome = connect_outcomes_.front();
+        connect_outcomes_.pop_front();
+      }
+    }
+    if (outcome != Outcome::kNever) {
+      const cxrError result = outcome == Outcome::kConnect
+                                  ? cxrError_Success
+                                  : cxrError_Not_Connected;
+      reporters_.emplace_back([this, result]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        worker_->OnConnectResult(result);
+      });
+    }
+    return cxrError_Success;
+  }
+
+  void Destroy() {
+    ++destroys;
+    alive = false;
+  }
+
+  ConnectionWorker* worker_ = nullptr;
+  std::mutex mutex_;
+  std::deque<cxrError> create_errors_;
+  std::deque<Outcome> connect_outcomes_;
+  // Only touched by the worker thread.
+  std::vector<std::thread> reporters_;
+};
+
+// A fake receiver wired to a worker.
+struct Fixture {
+  Fixture() : worker(receiver.MakeSteps()) { receiver.set_worker(&worker); }
+  ~Fixture() {
+    worker.Stop();
+    receiver.JoinReporters();
+  }
+
+  FakeReceiver receiver;
+  ConnectionWorker worker;
+};
+
+int64_t ElapsedMs(int64_t start_ns) {
+  return (host_tests::NowNs() - start_ns) / 1000000;
+}
+
+// Polls GetState() as the render loop does.
+// @return false if state wasn't reached within timeout_ms.
+bool WaitForState(const ConnectionWorker& worker, State state,
+                  int timeout_ms = 5000) {
+  const int64_t start = host_tests::NowNs();
+  while (worker.GetState() != state) {
+    if (ElapsedMs(start) > timeout_ms) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+void TestConnects() {
+  Fixture f;
+  CHECK(f.worker.GetState() == State::kIdle);
+  CHECK(f.worker.Start());
+  // Only one connection at a time.
+  CHECK(!f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kStreaming));
+  CHECK(f.worker.GetLastError() == cxrError_Success);
+  CHECK(f.receiver.prepares == 1);
+  CHECK(f.receiver.creates == 1);
+  CHECK(f.receiver.connects == 1);
+  CHECK(f.receiver.alive);
+
+  f.worker.Stop();
+  CHECK(f.worker.GetState() == State::kIdle);
+  CHECK(!f.receiver.alive);
+}
+
+void TestPassesThroughConnecting() {
+  Fixture f;
+  f.receiver.Script({}, {Outcome::kNever});
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kConnecting));
+  f.worker.Stop();
+}
+
+void TestCreateFails() {
+  Fixture f;
+  f.receiver.Script({cxrError_Client_Setup_Failed}, {});
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kIdle));
+  CHECK(f.worker.GetLastError() == cxrError_Client_Setup_Failed);
+  CHECK(f.receiver.connects == 0);
+
+  // Another Start() tries again from scratch.
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kStreaming));
+  CHECK(f.worker.GetLastError() == cxrError_Success);
+}
+
+void TestConnectFails() {
+  Fixture f;
+  f.receiver.Script({}, {Outcome::kFail});
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kIdle));
+  CHECK(f.worker.GetLastError() == cxrError_Not_Connected);
+  // The first connection doesn't retry.
+  CHECK(f.receiver.connects == 1);
+}
+
+void TestReconnectsWithBackoff() {
+  Fixture f;
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kStreaming));
+
+  f.receiver.Script({}, {Outcome::kFail, Outcome::kFail, Outcome::kConnect});
+  const int64_t start = host_tests::NowNs();
+  f.worker.OnConnectionLost();
+  CHECK(f.worker.GetState() == State::kReconnecting);
+  CHECK(WaitForState(f.worker, State::kStreaming));
+
+  // Waits 500 ms, then 1000 ms, between the three attempts.
+  CHECK(ElapsedMs(start) >= 1500);
+  CHECK(f.receiver.prepares == 2);
+  CHECK(f.receiver.creates == 4);
+  // Each attempt starts over with a new receiver.
+  CHECK(f.receiver.destroys == 3);
+}
+
+void TestReconnectGivesUp() {
+  Fixture f;
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kStreaming));
+
+  f.receiver.Script({}, {Outcome::kFail, Outcome::kFail, Outcome::kFail});
+  f.worker.OnConnectionLost();
+  CHECK(WaitForState(f.worker, State::kIdle));
+  CHECK(f.worker.GetLastError() == cxrError_Not_Connected);
+  CHECK(f.receiver.connects == 4);
+}
+
+void TestRenegotiate() {
+  Fixture f;
+  // Nothing to renegotiate before streaming.
+  f.worker.Renegotiate();
+  CHECK(f.worker.GetState() == State::kIdle);
+
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kStreaming));
+  f.worker.Renegotiate();
+  CHECK(WaitForState(f.worker, State::kStreaming));
+  CHECK(f.receiver.prepares == 2);
+  CHECK(f.receiver.connects == 2);
+}
+
+// Stop() runs on the UI thread, and mustn't wait for a connection.
+void TestStopDuringConnect() {
+  Fixture f;
+  f.receiver.Script({}, {Outcome::kNever});
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kConnecting));
+
+  const int64_t start = host_tests::NowNs();
+  f.worker.Stop();
+  CHECK(ElapsedMs(start) < 100);
+  CHECK(f.worker.GetState() == State::kIdle);
+  CHECK(f.worker.GetLastError() == cxrError_Success);
+  CHECK(!f.receiver.alive);
+
+  // A result turning up late is ignored.
+  f.worker.OnConnectResult(cxrError_Success);
+  CHECK(f.worker.GetState() == State::kIdle);
+}
+
+void TestStopDuringBackoff() {
+  Fixture f;
+  CHECK(f.worker.Start());
+  CHECK(WaitForState(f.worker, State::kStreaming));
+
+  f.receiver.Script({}, {Outcome::kFail, Outcome::kFail});
+  f.worker.OnConnectionLost();
+  // Wait for the first attempt to fail, then stop in the 500 ms backoff.
+  const int64_t deadline = host_tests::NowNs() + 5000000000LL;
+  while (f.receiver.connects < 2 && host_tests::NowNs() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  const int64_t start = host_tests::NowNs();
+  f.worker.Stop();
+  CHECK(ElapsedMs(start) < 100);
+  CHECK(f.worker.GetState() == State::kIdle);
+  CHECK(f.receiver.connects == 2);
+  CHECK(!f.receiver.alive);
+}
+
+void TestDestroyWhileConnecting() {
+  FakeReceiver receiver;
+  {
+    ConnectionWorker worker(receiver.MakeSteps());
+    receiver.set_worker(&worker);
+    receiver.Script({}, {Outcome::kNever});
+    CHECK(worker.Start());
+    CHECK(WaitForState(worker, State::kConnecting));
+    // The destructor stops the worker without waiting for the connection.
+  }
+  CHECK(receiver.connects == 1);
+  receiver.JoinReporters();
+}
+
+}  // namespace
+
+int main() {
+  TestConnects();
+  TestPassesThroughConnecting();
+  TestCreateFails();
+  TestConnectFails();
+  TestReconnectsWithBackoff();
+  TestReconnectGivesUp();
+  TestRenegotiate();
+  TestStopDuringConnect();
+  TestStopDuringBackoff();
+  TestDestroyWhileConnecting();
+  return host_tests::Result();
+}
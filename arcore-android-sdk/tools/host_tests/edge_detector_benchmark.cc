@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Benchmarks the computervision_c edge detector against the scalar Sobel loop
+// it replaced in CpuImageRenderer, at common camera image sizes, and checks
+// that both write the same pixels.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "edge_detector.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr int kSobelEdgeThreshold = 128 * 128;
+// Never written by the detectors, so untouched border pixels compare equal.
+constexpr uint8_t kUnwritten = 0x55;
+
+// The per-pixel loop of the old DetectEdge(), reading the Y plane directly
+// instead of through AImage.
+void ScalarDetectEdge(const uint8_t* input_pixels, int32_t width,
+                      int32_t height, int32_t stride, uint8_t* output_pixels) {
+  for (int j = 1; j < height - 1; j++) {
+    for (int i = 1; i < width - 1; i++) {
+      int offset = (j * stride) + i;
+
+      int a00 = input_pixels[offset - stride - 1];
+      int a01 = input_pixels[offset - stride];
+      int a02 = input_pixels[offset - stride + 1];
+      int a10 = input_pixels[offset - 1];
+      int a12 = input_pixels[offset + 1];
+      int a20 = input_pixels[offset + stride - 1];
+      int a21 = input_pixels[offset + stride];
+      int a22 = input_pixels[offset + stride + 1];
+
+      int x_sum = -a00 - (2 * a10) - a20 + a02 + (2 * a12) + a22;
+      int y_sum = a00 + (2 * a01) + a02 - a20 - (2 * a21) - a22;
+
+      if ((x_sum * x_sum) + (y_sum * y_sum) > kSobelEdgeThreshold) {
+        output_pixels[(j * width) + i] = static_cast<uint8_t>(0xFF);
+      } else {
+        output_pixels[(j * width) + i] = static_cast<uint8_t>(0x1F);
+      }
+    }
+  }
+}
+
+// A Y plane with smooth shading, sensor noise and boxes of random contrast,
+// so that gradients land below, near and far above the threshold.  Rows are padded
+// as camera buffers are.
+std::vector<uint8_t> MakeImage(int32_t width, int32_t height, int32_t stride) {
+  std::mt19937 rng(width * height);
+  std::normal_distribution<float> noise(0.0f, 6.0f);
+  // Box steps from 0 to 96 levels, around the 32 that reaches the threshold.
+  std::uniform_real_distribution<float> step(0.0f, 96.0f);
+  const int32_t boxes_x = width / 37 + 1;
+  std::vector<float> box_steps(boxes_x * (height / 29 + 1));
+  for (float& box_step : box_steps) box_step = step(rng);
+
+  std::vector<uint8_t> image(stride * height, 0);
+  for (int32_t y = 0; y < height; ++y) {
+    for (int32_t x = 0; x < width; ++x) {
+      float value = 64.0f + 96.0f * x / width + 32.0f * y / height;
+      value += box_steps[(y / 29) * boxes_x + x / 37] + noise(rng);
+      image[y * stride + x] =
+          static_cast<uint8_t>(std::max(0.0f, std::min(value, 255.0f)));
+    }
+  }
+  return image;
+}
+
+// Repeats a detection for about half a second.  @return ms per image.
+template <typename Detect>
+double TimeDetect(Detect detect) {
+  int runs = 0;
+  const int64_t start = host_tests::NowNs();
+  int64_t elapsed = 0;
+  do {
+    detect();
+    ++runs;
+    elapsed = host_tests::NowNs() - start;
+  } while (elapsed < 500000000);
+  return elapsed / 1e6 / runs;
+}
+
+// @return false if either detector differs from the scalar loop.
+bool Run(int32_t width, int32_t height,
+         computer_vision::EdgeDetector* detector) {
+  const int32_t stride = (width + 63) / 64 * 64 + 64;
+  const std::vector<uint8_t> input = MakeImage(width, height, stride);
+  std::vector<uint8_t> expected(width * height, kUnwritten);
+  std::vector<uint8_t> rows(width * height, kUnwritten);
+  std::vector<uint8_t> tiled(width * height, kUnwritten);
+
+  ScalarDetectEdge(input.data(), width, height, stride, expected.data());
+  computer_vision::DetectEdgeRows(input.data(), width, stride, 1, height - 1,
+                                  rows.data());
+  detector->Detect(input.data(), width, height, stride, tiled.data());
+  const bool identical = rows == expected && tiled == expected;
+
+  const double scalar_ms = TimeDetect([&]() {
+    ScalarDetectEdge(input.data(), width, height, stride, expected.data());
+    host_tests::DoNotOptimize(expected.data());
+  });
+  const double rows_ms = TimeDetect([&]() {
+    computer_vision::DetectEdgeRows(input.data(), width, stride, 1,
+                                    height - 1, rows.data());
+    host_tests::DoNotOptimize(rows.data());
+  });
+  const double tiled_ms = TimeDetect([&]() {
+    detector->Detect(input.data(), width, height, stride, tiled.data());
+    host_tests::DoNotOptimize(tiled.data());
+  });
+
+  const int edges = std::count(expected.begin(), expected.end(), 0xFF);
+  std::printf(
+      "%4dx%-4d %4.1f%% edges  scalar %6.2f ms  rows %6.2f ms (%4.1fx)  "
+      "workers %6.2f ms (%4.1fx)  %s\n",
+      width, height, 100.0 * edges / (width * height), scalar_ms, rows_ms,
+      scalar_ms / rows_ms, tiled_ms, scalar_ms / tiled_ms,
+      identical ? "identical" : "DIFFERENT");
+  return identical;
+}
+
+}  // namespace
+
+int main() {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  std::printf("DetectEdgeRows: NEON\n");
+#elif defined(__SSE2__)
+  std::printf("DetectEdgeRows: SSE2\n");
+#else
+  std::printf("DetectEdgeRows: scalar\n");
+#endif
+
+  computer_vision::EdgeDetector detector;
+  bool identical = true;
+  identical = Run(640, 480, &detector) && identical;
+  identical = Run(1280, 720, &detector) && identical;
+  identical = Run(1920, 1080, &detector) && identical;
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Benchmarks MicUplink on a synthetic minute of microphone input: room noise
+// with talk spurts, delivered in bursts of varying size as Oboe does.
+// Reports the send rate and bandwidth against sending every burst, how much
+// of the speech got through, and the processing cost.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "mic_uplink.h"
+#include "test_util.h"
+
+namespace {
+
+using hello_ar::MicUplink;
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int kChannels = MicUplink::kChannels;
+constexpr int kSeconds = 60;
+constexpr int32_t kFrames = kSampleRate * kSeconds;
+
+struct Input {
+  std::vector<int16_t> samples;    // interleaved
+  std::vector<bool> speech;        // per frame
+  std::vector<int32_t> bursts;     // frames per recording callback
+};
+
+// Noise at about -55 dBFS, with 1.5 s of speech-like sound every 4 s: a
+// 150 Hz voice and its harmonics at about -20 dBFS, chopped into syllables.
+Input MakeInput() {
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0f, 60.0f);
+  std::uniform_int_distribution<int> burst_size(0, 2);
+  const int32_t kBurstSizes[] = {96, 192, 240};
+
+  Input input;
+  input.samples.resize(kFrames * kChannels);
+  input.speech.resize(kFrames);
+  for (int32_t i = 0; i < kFrames; ++i) {
+    const double t = static_cast<double>(i) / kSampleRate;
+    const bool speech = std::fmod(t, 4.0) >= 2.5;
+    float value = noise(rng);
+    if (speech) {
+      const double syllable = std::max(0.0, std::sin(2.0 * M_PI * 4.0 * t));
+      double voice = 0.0;
+      for (int h = 1; h <= 5; ++h) {
+        voice += std::sin(2.0 * M_PI * 150.0 * h * t) / h;
+      }
+      value += static_cast<float>(2500.0 * syllable * voice);
+    }
+    const int16_t sample = static_cast<int16_t>(
+        std::max(-32768.0f, std::min(value, 32767.0f)));
+    input.samples[i * kChannels] = sample;
+    input.samples[i * kChannels + 1] = sample;
+    input.speech[i] = speech;
+  }
+
+  for (int32_t done = 0; done < kFrames;) {
+    const int32_t frames = std::min(kBurstSizes[burst_size(rng)], kFrames - done);
+    input.bursts.push_back(frames);
+    done += frames;
+  }
+  return input;
+}
+
+// Identifies sent packets by their first samples, which the noise makes
+// unique.
+uint64_t PacketKey(const int16_t* samples) {
+  uint64_t key = 0;
+  for (int i = 0; i < 4; ++i) {
+    key = (key << 16) | static_cast<uint16_t>(samples[i * kChannels]);
+  }
+  return key;
+}
+
+void PushAll(const Input& input, MicUplink* uplink) {
+  const int16_t* samples = input.samples.data();
+  for (int32_t frames : input.bursts) {
+    uplink->Push(samples, frames);
+    samples += frames * kChannels;
+  }
+}
+
+void Run(int32_t packet_ms, bool suppress_silence, const Input& input) {
+  const int32_t packet_frames = kSampleRate * packet_ms / 1000;
+  const int32_t packets = kFrames / packet_frames;
+
+  // Which packets carry speech, and where each one starts.
+  std::vector<bool> packet_speech(packets);
+  std::unordered_map<uint64_t, int32_t> packet_index;
+  for (int32_t p = 0; p < packets; ++p) {
+    const int32_t first = p * packet_frames;
+    packet_speech[p] = std::any_of(input.speech.begin() + first,
+                                   input.speech.begin() + first + packet_frames,
+                                   [](bool speech) { return speech; });
+    packet_index[PacketKey(&input.samples[first * kChannels])] = p;
+  }
+
+  std::vector<bool> sent(packets);
+  int32_t sends = 0;
+  MicUplink uplink([&](const int16_t* samples, int32_t frames) {
+    ++sends;
+    const auto it = packet_index.find(PacketKey(samples));
+    if (it != packet_index.end() && frames == packet_frames) {
+      sent[it->second] = true;
+    }
+  });
+  uplink.Reset(kSampleRate, packet_ms, suppress_silence);
+  PushAll(input, &uplink);
+
+  int32_t speech_packets = 0;
+  int32_t speech_sent = 0;
+  int32_t silence_packets = 0;
+  int32_t silence_sent = 0;
+  for (int32_t p = 0; p < packets; ++p) {
+    if (packet_speech[p]) {
+      ++speech_packets;
+      speech_sent += sent[p];
+    } else {
+      ++silence_packets;
+      silence_sent += sent[p];
+    }
+  }
+
+  // Processing cost, with a send that does nothing.
+  MicUplink timed([](const int16_t* samples, int32_t) {
+    host_tests::DoNotOptimize(samples);
+  });
+  constexpr int kRepeats = 20;
+  int64_t elapsed_ns = 0;
+  for (int r = 0; r < kRepeats; ++r) {
+    timed.Reset(kSampleRate, packet_ms, suppress_silence);
+    const int64_t start = host_tests::NowNs();
+    PushAll(input, &timed);
+    elapsed_ns += host_tests::NowNs() - start;
+  }
+  const double ns_per_second_of_audio =
+      static_cast<double>(elapsed_ns) / kRepeats / kSeconds;
+
+  const double bytes_per_frame = kChannels * sizeof(int16_t);
+  std::printf("%2d ms packets, VAD %-3s  %6.1f sends/s  %5.1f KB/s  "
+              "speech sent %5.1f%%  silence sent %5.1f%%  %6.1f us per s of audio\n",
+              packet_ms, suppress_silence ? "on" : "off",
+              static_cast<double>(sends) / kSeconds,
+              sends * packet_frames * bytes_per_frame / 1024.0 / kSeconds,
+              100.0 * speech_sent / speech_packets,
+              100.0 * silence_sent / silence_packets,
+              ns_per_second_of_audio / 1000.0);
+}
+
+}  // namespace
+
+int main() {
+  const Input input = MakeInput();
+  const double bytes_per_frame = kChannels * sizeof(int16_t);
+  std::printf("%d s of input in %zu bursts\n", kSeconds, input.bursts.size());
+  std::printf("every burst          %6.1f sends/s  %5.1f KB/s\n",
+              static_cast<double>(input.bursts.size()) / kSeconds,
+              kFrames * bytes_per_frame / 1024.0 / kSeconds);
+  for (int32_t packet_ms : {10, 20}) {
+    Run(packet_ms, false, input);
+    Run(packet_ms, true, input);
+  }
+  return 0;
+}
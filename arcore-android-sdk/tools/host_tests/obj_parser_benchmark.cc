@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Benchmarks the OBJ parser behind util::LoadObjFile() against the
+// sscanf-based loader it replaced, on the sample models and on generated
+// grids up to tens of MB, and checks that both give the same triangles.
+//
+// Built once per sample, with OBJ_SAMPLE_NAMESPACE naming its namespace.
+//
+// Usage: obj_parser_benchmark_<sample> [model.obj...]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "obj_parser.h"
+#include "test_util.h"
+
+namespace {
+
+using OBJ_SAMPLE_NAMESPACE::util::ParseObj;
+
+struct Mesh {
+  std::vector<GLfloat> vertices;
+  std::vector<GLfloat> normals;
+  std::vector<GLfloat> uvs;
+};
+
+// The LoadObjFile() of the samples before the parser was rewritten, reading
+// from a string instead of the asset.  It outputs one vertex per face corner,
+// and wraps indices past 65535.
+bool LegacyLoadObj(const std::string& file_buffer, Mesh* out) {
+  std::vector<GLfloat> temp_positions;
+  std::vector<GLfloat> temp_normals;
+  std::vector<GLfloat> temp_uvs;
+  std::vector<GLushort> vertex_indices;
+  std::vector<GLushort> normal_indices;
+  std::vector<GLushort> uv_indices;
+
+  std::stringstream file_string_stream(file_buffer);
+
+  while (!file_string_stream.eof()) {
+    char line_header[128];
+    file_string_stream.getline(line_header, 128);
+
+    if (line_header[0] == 'v' && line_header[1] == 'n') {
+      GLfloat normal[3];
+      int matches = sscanf(line_header, "vn %f %f %f\n", &normal[0], &normal[1],
+                           &normal[2]);
+      if (matches != 3) {
+        return false;
+      }
+      temp_normals.push_back(normal[0]);
+      temp_normals.push_back(normal[1]);
+      temp_normals.push_back(normal[2]);
+    } else if (line_header[0] == 'v' && line_header[1] == 't') {
+      GLfloat uv[2];
+      int matches = sscanf(line_header, "vt %f %f\n", &uv[0], &uv[1]);
+      if (matches != 2) {
+        return false;
+      }
+      temp_uvs.push_back(uv[0]);
+      temp_uvs.push_back(uv[1]);
+    } else if (line_header[0] == 'v') {
+      GLfloat vertex[3];
+      int matches = sscanf(line_header, "v %f %f %f\n", &vertex[0], &vertex[1],
+                           &vertex[2]);
+      if (matches != 3) {
+        return false;
+      }
+      temp_positions.push_back(vertex[0]);
+      temp_positions.push_back(vertex[1]);
+      temp_positions.push_back(vertex[2]);
+    } else if (line_header[0] == 'f') {
+      char* face_line = &line_header[1];
+
+      unsigned int vertex_index[4];
+      unsigned int normal_index[4];
+      unsigned int texture_index[4];
+
+      std::vector<char*> per_vert_info_list;
+      char* per_vert_info_list_c_str;
+      char* face_line_iter = face_line;
+      while ((per_vert_info_list_c_str =
+                  strtok_r(face_line_iter, " ", &face_line_iter))) {
+        per_vert_info_list.push_back(per_vert_info_list_c_str);
+      }
+
+      bool is_normal_available = false;
+      bool is_uv_available = false;
+      for (size_t i = 0; i < per_vert_info_list.size(); ++i) {
+        char* per_vert_info;
+        int per_vert_infor_count = 0;
+
+        bool is_vertex_normal_only_face =
+            (strstr(per_vert_info_list[i], "//") != nullptr);
+
+        char* per_vert_info_iter = per_vert_info_list[i];
+        while ((per_vert_info =
+                    strtok_r(per_vert_info_iter, "/", &per_vert_info_iter))) {
+          switch (per_vert_infor_count) {
+            case 0:
+              vertex_index[i] = atoi(per_vert_info);  // NOLINT
+              break;
+            case 1:
+              if (is_vertex_normal_only_face) {
+                normal_index[i] = atoi(per_vert_info);  // NOLINT
+                is_normal_available = true;
+              } else {
+                texture_index[i] = atoi(per_vert_info);  // NOLINT
+                is_uv_available = true;
+              }
+              break;
+            case 2:
+              if (!is_vertex_normal_only_face) {
+                normal_index[i] = atoi(per_vert_info);  // NOLINT
+                is_normal_available = true;
+                break;
+              }
+              return false;
+            default:
+              return false;
+          }
+          per_vert_infor_count++;
+        }
+      }
+
+      int vertices_count = per_vert_info_list.size();
+      for (int i = 2; i < vertices_count; ++i) {
+        vertex_indices.push_back(vertex_index[0] - 1);
+        vertex_indices.push_back(vertex_index[i - 1] - 1);
+        vertex_indices.push_back(vertex_index[i] - 1);
+
+        if (is_normal_available) {
+          normal_indices.push_back(normal_index[0] - 1);
+          normal_indices.push_back(normal_index[i - 1] - 1);
+          normal_indices.push_back(normal_index[i] - 1);
+        }
+
+        if (is_uv_available) {
+          uv_indices.push_back(texture_index[0] - 1);
+          uv_indices.push_back(texture_index[i - 1] - 1);
+          uv_indices.push_back(texture_index[i] - 1);
+        }
+      }
+    }
+  }
+
+  bool is_normal_available = (!normal_indices.empty());
+  bool is_uv_available = (!uv_indices.empty());
+
+  if (is_normal_available && normal_indices.size() != vertex_indices.size()) {
+    return false;
+  }
+  if (is_uv_available && uv_indices.size() != vertex_indices.size()) {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < vertex_indices.size(); i++) {
+    unsigned int vertex_index = vertex_indices[i];
+    out->vertices.push_back(temp_positions[vertex_index * 3]);
+    out->vertices.push_back(temp_positions[vertex_index * 3 + 1]);
+    out->vertices.push_back(temp_positions[vertex_index * 3 + 2]);
+
+    if (is_normal_available) {
+      unsigned int normal_index = normal_indices[i];
+      out->normals.push_back(temp_normals[normal_index * 3]);
+      out->normals.push_back(temp_normals[normal_index * 3 + 1]);
+      out->normals.push_back(temp_normals[normal_index * 3 + 2]);
+    }
+
+    if (is_uv_available) {
+      unsigned int uv_index = uv_indices[i];
+      out->uvs.push_back(temp_uvs[uv_index * 2]);
+      out->uvs.push_back(temp_uvs[uv_index * 2 + 1]);
+    }
+  }
+  return true;
+}
+
+// Expands an indexed attribute to one value per triangle corner, as the
+// legacy loader outputs it.
+std::vector<GLfloat> Expand(const std::vector<GLfloat>& values, int size,
+                            const std::vector<GLuint>& indices) {
+  std::vector<GLfloat> expanded;
+  if (values.empty()) {
+    return expanded;
+  }
+  expanded.reserve(indices.size() * size);
+  for (GLuint index : indices) {
+    expanded.insert(expanded.end(), &values[index * size],
+                    &values[index * size] + size);
+  }
+  return expanded;
+}
+
+// A grid of n by n vertices with normals and uvs, and one quad per cell, as
+// a scanned or tessellated model would be exported.
+std::string MakeGrid(int n) {
+  std::string obj;
+  char line[128];
+  for (int y = 0; y < n; ++y) {
+    for (int x = 0; x < n; ++x) {
+      const float u = static_cast<float>(x) / (n - 1);
+      const float v = static_cast<float>(y) / (n - 1);
+      const float height = 0.1f * std::sin(u * 12.0f) * std::cos(v * 9.0f);
+      std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\n",
+                    u - 0.5f, height, v - 0.5f, u, v);
+      obj += line;
+    }
+  }
+  obj += "vn 0.000000 1.000000 0.000000\n";
+  for (int y = 0; y + 1 < n; ++y) {
+    for (int x = 0; x + 1 < n; ++x) {
+      const int a = y * n + x + 1;
+      const int b = a + 1;
+      const int c = a + n + 1;
+      const int d = a + n;
+      std::snprintf(line, sizeof(line), "f %d/%d/1 %d/%d/1 %d/%d/1 %d/%d/1\n",
+                    a, a, b, b, c, c, d, d);
+      obj += line;
+    }
+  }
+  return obj;
+}
+
+// Repeats a load for about half a second.  @return ms per load.
+template <typename Load>
+double TimeLoad(Load load) {
+  int runs = 0;
+  const int64_t start = host_tests::NowNs();
+  int64_t elapsed = 0;
+  do {
+    load();
+    ++runs;
+    elapsed = host_tests::NowNs() - start;
+  } while (elapsed < 500000000);
+  return elapsed / 1e6 / runs;
+}
+
+// @return false if the parsers disagree where the legacy one is correct.
+bool Run(const char* name, const std::string& obj) {
+  std::vector<GLfloat> vertices;
+  std::vector<GLfloat> normals;
+  std::vector<GLfloat> uvs;
+  std::vector<GLuint> indices;
+  const char* begin = obj.data();
+  const char* end = obj.data() + obj.size();
+  if (!ParseObj(begin, end, &vertices, &normals, &uvs, &indices, nullptr)) {
+    std::printf("%s: parse failed\n", name);
+    return false;
+  }
+
+  Mesh legacy;
+  const bool legacy_ok = LegacyLoadObj(obj, &legacy);
+
+  // Old indices were 16-bit, so larger models came out scrambled.
+  const size_t positions = vertices.size() / 3;
+  const bool comparable = legacy_ok && positions <= 65536;
+  bool identical = true;
+  if (comparable) {
+    identical = legacy.vertices == Expand(vertices, 3, indices) &&
+                legacy.normals == Expand(normals, 3, indices) &&
+                legacy.uvs == Expand(uvs, 2, indices);
+  }
+
+  const double new_ms = TimeLoad([&]() {
+    ParseObj(begin, end, &vertices, &normals, &uvs, &indices, nullptr);
+    host_tests::DoNotOptimize(indices.data());
+  });
+  const double legacy_ms = TimeLoad([&]() {
+    Mesh mesh;
+    LegacyLoadObj(obj, &mesh);
+    host_tests::DoNotOptimize(mesh.vertices.data());
+  });
+
+  const double mb = obj.size() / 1e6;
+  std::printf(
+      "%-22s %7.2f MB %7zu vertices  old %8.2f ms  new %8.2f ms (%4.0f MB/s) "
+      " %5.2fx  %s\n",
+      name, mb, positions, legacy_ms, new_ms, mb / (new_ms / 1000),
+      legacy_ms / new_ms,
+      !comparable ? "not comparable" : identical ? "identical" : "DIFFERENT");
+  return identical;
+}
+
+bool ReadFile(const char* path, std::string* out) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  *out = contents.str();
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<std::string> paths(argv + 1, argv + argc);
+  if (paths.empty()) {
+    for (const char* model : {"andy.obj", "andy_shadow.obj"}) {
+      paths.push_back(std::string(SAMPLE_MODELS_DIR "/") + model);
+    }
+  }
+
+  bool identical = true;
+  for (const std::string& path : paths) {
+    std::string obj;
+    if (!ReadFile(path.c_str(), &obj)) {
+      std::fprintf(stderr, "Can't read %s\n", path.c_str());
+      return 1;
+    }
+    const size_t slash = path.find_last_of('/');
+    const std::string name =
+        slash == std::string::npos ? path : path.substr(slash + 1);
+    identical = Run(name.c_str(), obj) && identical;
+  }
+
+  for (int n : {64, 256, 700}) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "grid %dx%d", n, n);
+    identical = Run(name, MakeGrid(n)) && identical;
+  }
+  return identical ? 0 : 1;
+}
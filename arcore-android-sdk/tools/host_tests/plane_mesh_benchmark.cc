@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Benchmarks BuildFeatheredMesh() against the per-plane loop it replaced in
+// PlaneRenderer::UpdateForPlane(), on random convex polygons of the sizes
+// ARCore reports, and checks that both produce the same mesh.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "plane_mesh.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr float kFeatherLength = 0.2f;
+constexpr float kFeatherScale = 0.2f;
+
+// The mesh building of the old PlaneRenderer::UpdateForPlane(), minus the
+// ARCore calls, into vectors kept across planes as the renderer did.
+void LegacyFeather(const std::vector<glm::vec2>& raw_vertices,
+                   std::vector<glm::vec3>* vertices,
+                   std::vector<uint16_t>* triangles) {
+  vertices->clear();
+  triangles->clear();
+
+  const int32_t vertices_size = raw_vertices.size();
+  for (int32_t i = 0; i < vertices_size; ++i) {
+    vertices->push_back(glm::vec3(raw_vertices[i].x, raw_vertices[i].y, 0.0f));
+  }
+
+  for (int32_t i = 0; i < vertices_size; ++i) {
+    glm::vec2 v = raw_vertices[i];
+    const float scale =
+        1.0f - std::min((kFeatherLength / glm::length(v)), kFeatherScale);
+    const glm::vec2 result_v = scale * v;
+    vertices->push_back(glm::vec3(result_v.x, result_v.y, 1.0f));
+  }
+
+  const int32_t vertices_length = vertices->size();
+  const int32_t half_vertices_length = vertices_length / 2;
+
+  for (int i = half_vertices_length + 1; i < vertices_length - 1; ++i) {
+    triangles->push_back(half_vertices_length);
+    triangles->push_back(i);
+    triangles->push_back(i + 1);
+  }
+
+  for (int i = 0; i < half_vertices_length; ++i) {
+    triangles->push_back(i);
+    triangles->push_back((i + 1) % half_vertices_length);
+    triangles->push_back(i + half_vertices_length);
+
+    triangles->push_back(i + half_vertices_length);
+    triangles->push_back((i + 1) % half_vertices_length);
+    triangles->push_back((i + half_vertices_length + 1) % half_vertices_length +
+                         half_vertices_length);
+  }
+}
+
+// A convex polygon around the plane center, 0.5 to 3 m across.
+std::vector<glm::vec2> MakePolygon(int size, std::mt19937* rng) {
+  std::uniform_real_distribution<float> radius(0.25f, 1.5f);
+  std::uniform_real_distribution<float> angle(0.0f, 2.0f * static_cast<float>(M_PI));
+  const float rx = radius(*rng);
+  const float ry = radius(*rng);
+
+  std::vector<float> angles(size);
+  for (float& a : angles) a = angle(*rng);
+  std::sort(angles.begin(), angles.end());
+
+  std::vector<glm::vec2> polygon(size);
+  for (int i = 0; i < size; ++i) {
+    polygon[i] = glm::vec2(rx * std::cos(angles[i]), ry * std::sin(angles[i]));
+  }
+  return polygon;
+}
+
+// @return false if the two meshes differ in any bit.
+bool Run(int polygon_size) {
+  constexpr int kPlanes = 64;
+  constexpr int kRepeats = 2000;
+
+  std::mt19937 rng(polygon_size);
+  std::vector<std::vector<glm::vec2>> polygons;
+  for (int p = 0; p < kPlanes; ++p) {
+    polygons.push_back(MakePolygon(polygon_size, &rng));
+  }
+
+  std::vector<glm::vec3> legacy_vertices;
+  std::vector<uint16_t> legacy_triangles;
+  std::vector<glm::vec3> vertices(hello_ar::FeatheredVertexCount(polygon_size));
+  std::vector<uint16_t> indices(hello_ar::FeatheredIndexCount(polygon_size));
+
+  bool identical = true;
+  for (const std::vector<glm::vec2>& polygon : polygons) {
+    LegacyFeather(polygon, &legacy_vertices, &legacy_triangles);
+    hello_ar::BuildFeatheredMesh(polygon.data(), polygon_size, kFeatherLength,
+                                 kFeatherScale, vertices.data(), indices.data());
+    identical = identical && legacy_vertices.size() == vertices.size() &&
+                legacy_triangles.size() == indices.size() &&
+                std::memcmp(legacy_vertices.data(), vertices.data(),
+                            vertices.size() * sizeof(glm::vec3)) == 0 &&
+                std::memcmp(legacy_triangles.data(), indices.data(),
+                            indices.size() * sizeof(uint16_t)) == 0;
+  }
+
+  int64_t start = host_tests::NowNs();
+  for (int r = 0; r < kRepeats; ++r) {
+    for (const std::vector<glm::vec2>& polygon : polygons) {
+      LegacyFeather(polygon, &legacy_vertices, &legacy_triangles);
+      host_tests::DoNotOptimize(legacy_triangles.data());
+    }
+  }
+  const double legacy_ns =
+      static_cast<double>(host_tests::NowNs() - start) / kRepeats / kPlanes;
+
+  start = host_tests::NowNs();
+  for (int r = 0; r < kRepeats; ++r) {
+    for (const std::vector<glm::vec2>& polygon : polygons) {
+      hello_ar::BuildFeatheredMesh(polygon.data(), polygon_size,
+                                   kFeatherLength, kFeatherScale,
+                                   vertices.data(), indices.data());
+      host_tests::DoNotOptimize(indices.data());
+    }
+  }
+  const double new_ns =
+      static_cast<double>(host_tests::NowNs() - start) / kRepeats / kPlanes;
+
+  std::printf("%3d vertices  old %8.1f ns  new %8.1f ns  %5.2fx  %s\n",
+              polygon_size, legacy_ns, new_ns, legacy_ns / new_ns,
+              identical ? "identical" : "DIFFERENT");
+  return identical;
+}
+
+}  // namespace
+
+int main() {
+  std::printf("Per plane polygon, averaged over 64 planes\n");
+  bool identical = true;
+  for (int size : {4, 8, 16, 32, 64, 128}) {
+    identical = Run(size) && identical;
+  }
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Feeds synthetic pose streams through PoseHistory and through the matrix
+// comparison it replaced, and reports how often each finds the right camera
+// frame and how long a lookup takes.
+//
+// Each frame pushes one pose, and the "server" latches the pose sent a
+// random number of frames earlier, as a stream running behind the camera
+// does.
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "pose_history.h"
+#include "test_util.h"
+
+namespace {
+
+using hello_ar::PoseHistory;
+
+constexpr int kQueueLen = PoseHistory::kCapacity;
+constexpr int kFrames = 2000000;
+constexpr int kMaxLag = 8;
+
+// The lookup hello_cloudxr_c did before PoseHistory: compare the latched
+// matrix against every queued pose, newest first, with a 1e-4 tolerance.
+class LegacyPoseQueue {
+ public:
+  void Push(const cxrMatrix34& pose) {
+    poses_[current_idx_] = pose;
+    current_idx_ = (current_idx_ + 1) % kQueueLen;
+  }
+
+  int DetermineOffset(const cxrMatrix34& latched) const {
+    // current_idx_ is one past the newest pose.
+    const int newest = (current_idx_ + kQueueLen - 1) % kQueueLen;
+    for (int offset = 0; offset < kQueueLen; offset++) {
+      const cxrMatrix34& pose = poses_[(newest - offset + kQueueLen) % kQueueLen];
+      int not_match = 0;
+      for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+          if (fabsf(pose.m[i][j] - latched.m[i][j]) >= 0.0001f) not_match++;
+        }
+      }
+      if (not_match == 0) return offset;
+    }
+    return 0;
+  }
+
+ private:
+  cxrMatrix34 poses_[kQueueLen] = {};
+  int current_idx_ = 0;
+};
+
+// Yaw rotation plus translation, with sensor noise on every element.
+cxrMatrix34 MakePose(float yaw, float x, float noise, std::mt19937* rng) {
+  std::normal_distribution<float> jitter(0.0f, noise);
+  const float c = std::cos(yaw);
+  const float s = std::sin(yaw);
+  const float m[3][4] = {{c, 0.0f, s, x}, {0.0f, 1.0f, 0.0f, 1.5f},
+                         {-s, 0.0f, c, -0.5f}};
+  cxrMatrix34 pose;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      pose.m[i][j] = m[i][j] + (noise > 0.0f ? jitter(*rng) : 0.0f);
+    }
+  }
+  return pose;
+}
+
+struct Stream {
+  std::vector<cxrMatrix34> poses;
+  std::vector<int> lags;
+};
+
+Stream MakeStream(float yaw_per_frame, float meters_per_frame, float noise) {
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> lag_dist(0, kMaxLag);
+  Stream stream;
+  stream.poses.resize(kFrames);
+  stream.lags.resize(kFrames);
+  for (int i = 0; i < kFrames; ++i) {
+    stream.poses[i] =
+        MakePose(yaw_per_frame * i, meters_per_frame * i, noise, &rng);
+    stream.lags[i] = lag_dist(rng);
+  }
+  return stream;
+}
+
+// Plays the stream through both queues.  lookup(frame, latched) returns the
+// camera frame offset it found; the camera frame number of a pose is its
+// frame index, as BackgroundRenderer counts them.
+// @return the number of lookups that found the right offset.
+template <typename Lookup>
+int Play(const Stream& stream, PoseHistory* history, LegacyPoseQueue* legacy,
+         std::vector<uint64_t>* pose_ids, Lookup lookup) {
+  int correct = 0;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    (*pose_ids)[frame] = history->Push(stream.poses[frame], frame);
+    legacy->Push(stream.poses[frame]);
+
+    const int lag = stream.lags[frame];
+    if (frame >= lag) {
+      const int offset = lookup(frame, frame - lag);
+      host_tests::DoNotOptimize(offset);
+      correct += offset == lag;
+    }
+  }
+  return correct;
+}
+
+void Run(const char* name, float yaw_per_frame, float meters_per_frame,
+         float noise) {
+  const Stream stream = MakeStream(yaw_per_frame, meters_per_frame, noise);
+  std::vector<uint64_t> pose_ids(kFrames);
+  int lookups = 0;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    lookups += frame >= stream.lags[frame];
+  }
+
+  // Each lookup gets a run of its own, and the cost of pushing alone is
+  // subtracted from both.
+  int64_t start = host_tests::NowNs();
+  {
+    PoseHistory history;
+    LegacyPoseQueue legacy;
+    Play(stream, &history, &legacy, &pose_ids,
+         [](int, int) { return 0; });
+  }
+  const int64_t push_ns = host_tests::NowNs() - start;
+
+  start = host_tests::NowNs();
+  int history_correct;
+  {
+    PoseHistory history;
+    LegacyPoseQueue legacy;
+    history_correct = Play(
+        stream, &history, &legacy, &pose_ids, [&](int frame, int latched) {
+          uint64_t camera_frame = 0;
+          if (!history.FindCameraFrame(pose_ids[latched], &camera_frame)) {
+            return 0;
+          }
+          return frame - static_cast<int>(camera_frame);
+        });
+  }
+  const int64_t history_ns = host_tests::NowNs() - start - push_ns;
+
+  start = host_tests::NowNs();
+  int legacy_correct;
+  {
+    PoseHistory history;
+    LegacyPoseQueue legacy;
+    legacy_correct =
+        Play(stream, &history, &legacy, &pose_ids, [&](int, int latched) {
+          return legacy.DetermineOffset(stream.poses[latched]);
+        });
+  }
+  const int64_t legacy_ns = host_tests::NowNs() - start - push_ns;
+
+  std::printf("%-28s pose ID: %6.1f ns %6.2f%% right   "
+              "matrix compare: %6.1f ns %6.2f%% right\n",
+              name, static_cast<double>(history_ns) / lookups,
+              100.0 * history_correct / lookups,
+              static_cast<double>(legacy_ns) / lookups,
+              100.0 * legacy_correct / lookups);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d frames, server lag 0-%d frames\n", kFrames, kMaxLag);
+  Run("walking (1 cm, 0.5 deg)", 0.0087f, 0.01f, 1e-5f);
+  Run("slow pan (1 mm, 0.05 deg)", 0.00087f, 0.001f, 1e-5f);
+  Run("held still (sensor noise)", 0.0f, 0.0f, 2e-5f);
+  Run("tripod (no noise)", 0.0f, 0.0f, 0.0f);
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Stress test of the PoseHistory seqlock: a producer thread pushes poses as
+// fast as it can while a consumer thread reads them back, as the GL thread
+// and the CloudXR callback thread do.  Every pose is filled from its pose ID,
+// so a read mixing two writes, or a pose returned under the wrong ID, shows
+// up as a mismatch.
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "pose_history.h"
+#include "test_util.h"
+
+namespace {
+
+using hello_ar::PoseHistory;
+
+constexpr uint64_t kPushes = 20000000;
+
+// Element k of pose `id`.  Exact in a float while id stays below 2^20.
+float PoseElement(uint64_t id, int k) {
+  return static_cast<float>((id % (1 << 20)) * 16 + k);
+}
+
+cxrMatrix34 MakePose(uint64_t id) {
+  cxrMatrix34 pose;
+  for (int k = 0; k < 12; ++k) {
+    pose.m[k / 4][k % 4] = PoseElement(id, k);
+  }
+  return pose;
+}
+
+uint64_t CameraFrame(uint64_t id) { return id * 3 + 1; }
+
+bool PoseMatches(const cxrMatrix34& pose, uint64_t id) {
+  for (int k = 0; k < 12; ++k) {
+    if (pose.m[k / 4][k % 4] != PoseElement(id, k)) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  PoseHistory history;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&]() {
+    for (uint64_t i = 1; i <= kPushes; ++i) {
+      // IDs are assigned in push order, starting at 1.
+      history.Push(MakePose(i), CameraFrame(i));
+    }
+    done = true;
+  });
+
+  uint64_t reads = 0;
+  uint64_t torn_poses = 0;
+  uint64_t wrong_frames = 0;
+  uint64_t backwards = 0;
+  uint64_t lookups_found = 0;
+  uint64_t last_id = PoseHistory::kInvalidPoseId;
+  while (!done.load(std::memory_order_relaxed)) {
+    cxrMatrix34 pose;
+    const uint64_t id = history.GetLatest(&pose);
+    if (id == PoseHistory::kInvalidPoseId) continue;
+    ++reads;
+
+    if (!PoseMatches(pose, id)) ++torn_poses;
+    if (id < last_id) ++backwards;
+    last_id = id;
+
+    // Look up a pose a few pushes back, which the producer may be
+    // overwriting right now.
+    const uint64_t lookup_id = id > 8 ? id - (reads % 8) : id;
+    uint64_t camera_frame = 0;
+    if (history.FindCameraFrame(lookup_id, &camera_frame)) {
+      ++lookups_found;
+      if (camera_frame != CameraFrame(lookup_id)) ++wrong_frames;
+    }
+  }
+  producer.join();
+
+  std::printf("%llu pushes, %llu reads (%llu torn), %llu lookups found "
+              "(%llu wrong)\n",
+              static_cast<unsigned long long>(kPushes),
+              static_cast<unsigned long long>(reads),
+              static_cast<unsigned long long>(torn_poses),
+              static_cast<unsigned long long>(lookups_found),
+              static_cast<unsigned long long>(wrong_frames));
+
+  CHECK(reads > 0);
+  CHECK(torn_poses == 0);
+  CHECK(wrong_frames == 0);
+  CHECK(backwards == 0);
+
+  cxrMatrix34 pose;
+  CHECK(history.GetLatest(&pose) == kPushes);
+  CHECK(PoseMatches(pose, kPushes));
+  return host_tests::Result();
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Unit test of PoseHistory, the pose ID to camera frame map that
+// hello_cloudxr_c uses to match latched stream frames to camera images.
+
+#include <cstring>
+
+#include "pose_history.h"
+#include "test_util.h"
+
+namespace {
+
+using hello_ar::PoseHistory;
+
+cxrMatrix34 MakePose(float seed) {
+  cxrMatrix34 pose;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      pose.m[i][j] = seed + static_cast<float>(i * 4 + j);
+    }
+  }
+  return pose;
+}
+
+bool SamePose(const cxrMatrix34& a, const cxrMatrix34& b) {
+  return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+void TestEmpty() {
+  PoseHistory history;
+  cxrMatrix34 pose = MakePose(0.0f);
+  uint64_t camera_frame = 0;
+
+  CHECK(history.GetLatest(&pose) == PoseHistory::kInvalidPoseId);
+  CHECK(!history.FindCameraFrame(PoseHistory::kInvalidPoseId, &camera_frame));
+  CHECK(!history.FindCameraFrame(1, &camera_frame));
+}
+
+void TestIdsAndLookup() {
+  PoseHistory history;
+  uint64_t previous_id = PoseHistory::kInvalidPoseId;
+  for (int i = 0; i < 5; ++i) {
+    const uint64_t id = history.Push(MakePose(static_cast<float>(i)), 100 + i);
+    CHECK(id != PoseHistory::kInvalidPoseId);
+    CHECK(id == previous_id + 1);
+    previous_id = id;
+  }
+
+  cxrMatrix34 latest;
+  CHECK(history.GetLatest(&latest) == previous_id);
+  CHECK(SamePose(latest, MakePose(4.0f)));
+
+  for (int i = 0; i < 5; ++i) {
+    uint64_t camera_frame = 0;
+    CHECK(history.FindCameraFrame(previous_id - 4 + i, &camera_frame));
+    CHECK(camera_frame == static_cast<uint64_t>(100 + i));
+  }
+
+  // Not pushed yet.
+  uint64_t camera_frame = 0;
+  CHECK(!history.FindCameraFrame(previous_id + 1, &camera_frame));
+}
+
+void TestEviction() {
+  PoseHistory history;
+  const int pushes = PoseHistory::kCapacity * 3 + 5;
+  uint64_t last_id = PoseHistory::kInvalidPoseId;
+  for (int i = 0; i < pushes; ++i) {
+    last_id = history.Push(MakePose(static_cast<float>(i)), i);
+  }
+
+  // Exactly the last kCapacity poses are still known.
+  for (uint64_t id = 1; id <= last_id; ++id) {
+    uint64_t camera_frame = 0;
+    const bool found = history.FindCameraFrame(id, &camera_frame);
+    const bool expected = id + PoseHistory::kCapacity > last_id;
+    CHECK(found == expected);
+    if (found) {
+      CHECK(camera_frame == id - 1);
+    }
+  }
+}
+
+// A device held still sends the same pose again and again; each copy must
+// still map back to its own camera frame.
+void TestStillDevice() {
+  PoseHistory history;
+  const cxrMatrix34 still = MakePose(1.0f);
+  uint64_t ids[8];
+  for (int i = 0; i < 8; ++i) {
+    ids[i] = history.Push(still, 1000 + i);
+  }
+
+  for (int i = 0; i < 8; ++i) {
+    uint64_t camera_frame = 0;
+    CHECK(history.FindCameraFrame(ids[i], &camera_frame));
+    CHECK(camera_frame == static_cast<uint64_t>(1000 + i));
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestEmpty();
+  TestIdsAndLookup();
+  TestEviction();
+  TestStillDevice();
+  return host_tests::Result();
+}
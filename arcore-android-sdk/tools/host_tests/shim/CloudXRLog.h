@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Host stand-in for the CloudXR sample log header, which logs through the
+// Android log library.  Messages go to stderr instead.
+
+#ifndef HOST_TESTS_CLOUDXR_LOG_H_
+#define HOST_TESTS_CLOUDXR_LOG_H_
+
+#include <cstdio>
+
+#define CXR_LOG_HOST(level, ...)          \
+  do {                                    \
+    std::fprintf(stderr, level ": ");     \
+    std::fprintf(stderr, __VA_ARGS__);    \
+    std::fputc('\n', stderr);             \
+  } while (0)
+
+#define CXR_LOGV(...) CXR_LOG_HOST("V", __VA_ARGS__)
+#define CXR_LOGD(...) CXR_LOG_HOST("D", __VA_ARGS__)
+#define CXR_LOGI(...) CXR_LOG_HOST("I", __VA_ARGS__)
+#define CXR_LOGW(...) CXR_LOG_HOST("W", __VA_ARGS__)
+#define CXR_LOGE(...) CXR_LOG_HOST("E", __VA_ARGS__)
+
+#endif  // HOST_TESTS_CLOUDXR_LOG_H_
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Minimal checks and timing shared by the host tests and benchmarks.
+
+#ifndef HOST_TESTS_TEST_UTIL_H_
+#define HOST_TESTS_TEST_UTIL_H_
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace host_tests {
+
+inline int& FailureCount() {
+  static int failures = 0;
+  return failures;
+}
+
+// Exit code for main(): nonzero if any CHECK failed.
+inline int Result() {
+  if (FailureCount() > 0) {
+    std::fprintf(stderr, "%d check(s) failed\n", FailureCount());
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}
+
+inline int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Keeps the optimizer from dropping a benchmarked result.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace host_tests
+
+// Records a failure and carries on, so one run reports every broken check.
+#define CHECK(condition)                                               \
+  do {                                                                 \
+    if (!(condition)) {                                                \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__,      \
+                   __LINE__, #condition);                              \
+      ++host_tests::FailureCount();                                    \
+    }                                                                  \
+  } while (0)
+
+#endif  // HOST_TESTS_TEST_UTIL_H_
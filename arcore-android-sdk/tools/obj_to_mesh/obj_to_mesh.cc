@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Converts Wavefront OBJ models into the binary mesh format that Mesh loads
+// in the augmented_image_c and hello_ar_c samples (see their mesh.h).  The
+// .mesh file is packaged next to the .obj it was built from, and is used in
+// place of it.
+//
+// Build and run on Linux:
+//   cmake -S . -B build && cmake --build build
+//   build/obj_to_mesh models/andy.obj [models/andy.mesh]
+//
+// The OBJ is read by the samples' own util::ParseObj(), built from hello_ar_c,
+// so a .mesh holds exactly what Mesh::LoadObj() would make of its OBJ.
+// Indices are 16-bit unless there are more than 65536 vertices.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "obj_parser.h"
+
+namespace {
+
+// Must match MeshFileHeader in the samples' mesh.h.
+struct MeshFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t vertex_count;
+  uint32_t index_count;
+  uint32_t index_size;
+};
+
+struct Vertex {
+  float position[3];
+  float normal[3];
+  float uv[2];
+};
+
+constexpr char kMeshFileMagic[4] = {'M', 'E', 'S', 'H'};
+constexpr uint32_t kMeshFileVersion = 1;
+
+// Interleaves the parser's output as Mesh::LoadObj() does, with zero normals
+// and UVs when the OBJ has none.
+std::vector<Vertex> Interleave(const std::vector<GLfloat>& positions,
+                               const std::vector<GLfloat>& normals,
+                               const std::vector<GLfloat>& uvs) {
+  std::vector<Vertex> vertices(positions.size() / 3);
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    Vertex& vertex = vertices[i];
+    memcpy(vertex.position, &positions[i * 3], sizeof(vertex.position));
+    if (normals.empty()) {
+      memset(vertex.normal, 0, sizeof(vertex.normal));
+    } else {
+      memcpy(vertex.normal, &normals[i * 3], sizeof(vertex.normal));
+    }
+    if (uvs.empty()) {
+      memset(vertex.uv, 0, sizeof(vertex.uv));
+    } else {
+      memcpy(vertex.uv, &uvs[i * 2], sizeof(vertex.uv));
+    }
+  }
+  return vertices;
+}
+
+bool ReadFile(const std::string& path, std::string* out) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  char buffer[65536];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    out->append(buffer, read);
+  }
+  const bool success = !ferror(file);
+  fclose(file);
+  return success;
+}
+
+bool WriteMesh(const std::string& path, const std::vector<Vertex>& vertices,
+               const std::vector<GLuint>& indices) {
+  MeshFileHeader header;
+  memcpy(header.magic, kMeshFileMagic, sizeof(header.magic));
+  header.version = kMeshFileVersion;
+  header.vertex_count = vertices.size();
+  header.index_count = indices.size();
+  header.index_size = vertices.size() <= 65536 ? 2 : 4;
+
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(vertices.data(), sizeof(Vertex), vertices.size(),
+                        file) == vertices.size();
+  if (header.index_size == 2) {
+    std::vector<uint16_t> short_indices(indices.begin(), indices.end());
+    success = success && fwrite(short_indices.data(), sizeof(uint16_t),
+                                short_indices.size(),
+                                file) == short_indices.size();
+  } else {
+    success = success && fwrite(indices.data(), sizeof(GLuint),
+                                indices.size(), file) == indices.size();
+  }
+  return fclose(file) == 0 && success;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2 && argc != 3) {
+    fprintf(stderr, "usage: %s input.obj [output.mesh]\n", argv[0]);
+    return 1;
+  }
+
+  // The format is little-endian, like every device ARCore runs on.
+  const uint32_t one = 1;
+  if (*reinterpret_cast<const uint8_t*>(&one) != 1) {
+    fprintf(stderr, "big-endian hosts are not supported\n");
+    return 1;
+  }
+
+  const std::string input_path = argv[1];
+  std::string output_path;
+  if (argc == 3) {
+    output_path = argv[2];
+  } else {
+    const size_t dot = input_path.rfind('.');
+    output_path = input_path.substr(0, dot) + ".mesh";
+  }
+
+  std::string text;
+  if (!ReadFile(input_path, &text)) {
+    fprintf(stderr, "could not read %s: %s\n", input_path.c_str(),
+            strerror(errno));
+    return 1;
+  }
+
+  std::vector<GLfloat> positions;
+  std::vector<GLfloat> normals;
+  std::vector<GLfloat> uvs;
+  std::vector<GLuint> indices;
+  int error_line = 0;
+  if (!hello_ar::util::ParseObj(text.data(), text.data() + text.size(),
+                                &positions, &normals, &uvs, &indices,
+                                &error_line)) {
+    fprintf(stderr, "%s: unsupported or malformed obj at line %d\n",
+            input_path.c_str(), error_line);
+    return 1;
+  }
+  if (indices.empty()) {
+    fprintf(stderr, "%s: no faces\n", input_path.c_str());
+    return 1;
+  }
+
+  const std::vector<Vertex> vertices = Interleave(positions, normals, uvs);
+  if (!WriteMesh(output_path, vertices, indices)) {
+    fprintf(stderr, "could not write %s: %s\n", output_path.c_str(),
+            strerror(errno));
+    return 1;
+  }
+  printf("%s: %zu vertices, %zu triangles\n", output_path.c_str(),
+         vertices.size(), indices.size() / 3);
+  return 0;
+}